@@ -24,6 +24,21 @@ macro(helper_FIND_OPENSSL_LIB)
     endif()
 endmacro()
 
+# Helper macro to find liburing, required by the io_uring backend of Boost.Asio
+macro(helper_FIND_LIBURING_LIB)
+    if(NOT CMAKE_SYSTEM_NAME STREQUAL "Linux")
+        message(FATAL_ERROR "XAPI_USE_IO_URING is only supported on Linux")
+    endif()
+    find_path(LIBURING_INCLUDE_DIR liburing.h)
+    find_library(LIBURING_LIBRARY uring)
+    if(NOT LIBURING_INCLUDE_DIR OR NOT LIBURING_LIBRARY)
+        message(FATAL_ERROR "liburing not found. Please install liburing (e.g. liburing-dev) or disable XAPI_USE_IO_URING")
+    else()
+        include_directories(${LIBURING_INCLUDE_DIR})
+        message(STATUS "Using io_uring backend: ${LIBURING_LIBRARY}")
+    endif()
+endmacro()
+
 # Helper macro to find google test library
 macro(helper_FIND_GTEST_LIBS)
     include(FetchContent)
@@ -0,0 +1,94 @@
+#include "AllocationCounter.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+thread_local std::size_t t_allocationCount = 0;
+thread_local std::size_t t_allocatedBytes = 0;
+
+void *countedAllocate(std::size_t size)
+{
+    ++t_allocationCount;
+    t_allocatedBytes += size;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+namespace xapi
+{
+namespace benchmark
+{
+
+std::size_t allocationCount() noexcept
+{
+    return t_allocationCount;
+}
+
+std::size_t allocatedBytes() noexcept
+{
+    return t_allocatedBytes;
+}
+
+} // namespace benchmark
+} // namespace xapi
+
+void *operator new(std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return countedAllocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return countedAllocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
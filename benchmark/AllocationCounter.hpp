@@ -0,0 +1,30 @@
+#pragma once
+
+/**
+ * @file AllocationCounter.hpp
+ * @brief Per-thread heap allocation counters for benchmarks.
+ *
+ * Global operator new/delete are replaced in AllocationCounter.cpp, so every allocation made by
+ * the library on the calling thread is counted. Counters are per thread, which keeps the
+ * allocations of the server stand-in (running on its own thread) out of the measurements.
+ */
+
+#include <cstddef>
+
+namespace xapi
+{
+namespace benchmark
+{
+
+/**
+ * @brief Number of heap allocations made by the calling thread so far.
+ */
+std::size_t allocationCount() noexcept;
+
+/**
+ * @brief Number of bytes requested from the heap by the calling thread so far.
+ */
+std::size_t allocatedBytes() noexcept;
+
+} // namespace benchmark
+} // namespace xapi
@@ -0,0 +1,186 @@
+#pragma once
+
+/**
+ * @file BenchmarkServer.hpp
+ * @brief Local secure WebSocket server used as an xAPI stand-in by the benchmarks.
+ *
+ * The server listens on an ephemeral loopback port, with a self-signed certificate or over
+ * plain WebSocket, and runs on its own thread, so the client side of a benchmark can be
+ * measured in isolation.
+ * What a session does after the WebSocket handshake is decided by the benchmark.
+ */
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <boost/url.hpp>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace xapi
+{
+namespace benchmark
+{
+
+using ServerWebsocket = boost::beast::websocket::stream<boost::asio::ssl::stream<boost::beast::tcp_stream>>;
+using PlainServerWebsocket = boost::beast::websocket::stream<boost::beast::tcp_stream>;
+
+/**
+ * @brief Handler run for every accepted session once the WebSocket handshake is done.
+ */
+template <typename Websocket>
+using BasicSessionHandler = std::function<boost::asio::awaitable<void>(Websocket &)>;
+
+using SessionHandler = BasicSessionHandler<ServerWebsocket>;
+using PlainSessionHandler = BasicSessionHandler<PlainServerWebsocket>;
+
+template <typename Websocket> class BasicBenchmarkServer
+{
+  public:
+    static constexpr bool tls = std::is_same_v<Websocket, ServerWebsocket>;
+
+    BasicBenchmarkServer(const BasicBenchmarkServer &) = delete;
+    BasicBenchmarkServer &operator=(const BasicBenchmarkServer &) = delete;
+
+    /**
+     * @brief Starts listening on an ephemeral loopback port.
+     * @param handler The handler to run for every accepted session.
+     * @param deflate permessage-deflate settings of the server, disabled by default.
+     */
+    explicit BasicBenchmarkServer(BasicSessionHandler<Websocket> handler,
+                                  const boost::beast::websocket::permessage_deflate &deflate = {})
+        : m_sslContext(boost::asio::ssl::context::tls_server),
+          m_acceptor(m_ioContext, {boost::asio::ip::address_v4::loopback(), 0}), m_handler(std::move(handler)),
+          m_deflate(deflate)
+    {
+        if constexpr (tls)
+        {
+            useSelfSignedCertificate();
+        }
+        boost::asio::co_spawn(m_ioContext, acceptLoop(), boost::asio::detached);
+        m_thread = std::thread([this]() { m_ioContext.run(); });
+    }
+
+    ~BasicBenchmarkServer()
+    {
+        m_ioContext.stop();
+        m_thread.join();
+    }
+
+    /**
+     * @brief URL of the server, e.g. `wss://127.0.0.1:40123/path`.
+     * @param path The path to append.
+     */
+    boost::url url(const std::string &path = "/") const
+    {
+        return boost::urls::format("{}://127.0.0.1:{}{}", tls ? "wss" : "ws", m_acceptor.local_endpoint().port(),
+                                   path);
+    }
+
+    /**
+     * @brief Port the server listens on.
+     */
+    std::uint16_t port() const
+    {
+        return m_acceptor.local_endpoint().port();
+    }
+
+    /**
+     * @brief Server SSL context, e.g. to inspect or tune session resumption.
+     */
+    boost::asio::ssl::context &sslContext()
+    {
+        return m_sslContext;
+    }
+
+  private:
+    boost::asio::awaitable<void> acceptLoop()
+    {
+        for (;;)
+        {
+            auto socket = co_await m_acceptor.async_accept(boost::asio::use_awaitable);
+            boost::asio::co_spawn(m_ioContext, runSession(std::move(socket)), boost::asio::detached);
+        }
+    }
+
+    boost::asio::awaitable<void> runSession(boost::asio::ip::tcp::socket socket)
+    {
+        Websocket websocket = makeWebsocket(std::move(socket));
+        try
+        {
+            if constexpr (tls)
+            {
+                co_await websocket.next_layer().async_handshake(boost::asio::ssl::stream_base::server,
+                                                                boost::asio::use_awaitable);
+            }
+            websocket.set_option(m_deflate);
+            co_await websocket.async_accept(boost::asio::use_awaitable);
+            co_await m_handler(websocket);
+        }
+        catch (const boost::system::system_error &)
+        {
+            // Client went away, nothing to report
+        }
+    }
+
+    Websocket makeWebsocket(boost::asio::ip::tcp::socket socket)
+    {
+        if constexpr (tls)
+        {
+            return Websocket(std::move(socket), m_sslContext);
+        }
+        else
+        {
+            return Websocket(std::move(socket));
+        }
+    }
+
+    void useSelfSignedCertificate()
+    {
+        EVP_PKEY *key = EVP_EC_gen("P-256");
+        X509 *certificate = X509_new();
+        if (key == nullptr || certificate == nullptr)
+        {
+            throw std::runtime_error("Failed to allocate benchmark certificate");
+        }
+
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+        X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+        X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 60 * 60);
+        X509_set_pubkey(certificate, key);
+
+        X509_NAME *name = X509_get_subject_name(certificate);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("localhost"),
+                                   -1, -1, 0);
+        X509_set_issuer_name(certificate, name);
+        X509_sign(certificate, key, EVP_sha256());
+
+        const bool loaded = SSL_CTX_use_certificate(m_sslContext.native_handle(), certificate) == 1 &&
+                            SSL_CTX_use_PrivateKey(m_sslContext.native_handle(), key) == 1;
+        X509_free(certificate);
+        EVP_PKEY_free(key);
+        if (!loaded)
+        {
+            throw std::runtime_error("Failed to load benchmark certificate");
+        }
+    }
+
+    boost::asio::io_context m_ioContext;
+    boost::asio::ssl::context m_sslContext;
+    boost::asio::ip::tcp::acceptor m_acceptor;
+    BasicSessionHandler<Websocket> m_handler;
+    boost::beast::websocket::permessage_deflate m_deflate;
+    std::thread m_thread;
+};
+
+using BenchmarkServer = BasicBenchmarkServer<ServerWebsocket>;
+using PlainBenchmarkServer = BasicBenchmarkServer<PlainServerWebsocket>;
+
+} // namespace benchmark
+} // namespace xapi
@@ -0,0 +1,147 @@
+/**
+ * @file ClientStackBenchmark.cpp
+ * @brief Request latency and throughput of the whole XStationClient stack against a local server.
+ *
+ * The client is pointed at the local server stand-in through ConnectionOptions::endpoint, once over
+ * plain WebSocket and once over TLS, so the overhead of the library can be told apart from the
+ * overhead of TLS. The server answers every command at once, echoing its customTag.
+ */
+
+#include "BenchmarkServer.hpp"
+#include "xapi/XStationClient.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace xapi;
+
+namespace
+{
+
+constexpr std::size_t warmupRequests = 100;
+constexpr std::size_t measuredRequests = 10000;
+constexpr std::size_t requestsInFlight = 64;
+
+template <typename Websocket> boost::asio::awaitable<void> answerCommands(Websocket &websocket)
+{
+    boost::beast::flat_buffer buffer;
+    std::string response;
+    for (;;)
+    {
+        co_await websocket.async_read(buffer, boost::asio::use_awaitable);
+        const auto command = boost::json::parse(boost::beast::buffers_to_string(buffer.data())).as_object();
+        buffer.clear();
+
+        boost::json::object answer = {{"status", true}, {"returnData", {{"time", 1725545999000}}}};
+        if (command.at("command") == "login")
+        {
+            answer["streamSessionId"] = "benchmark";
+        }
+        if (const auto *customTag = command.if_contains("customTag"))
+        {
+            answer["customTag"] = *customTag;
+        }
+        response = boost::json::serialize(answer);
+        co_await websocket.async_write(boost::asio::buffer(response), boost::asio::use_awaitable);
+    }
+}
+
+struct Measurement
+{
+    std::vector<std::chrono::nanoseconds> latencies;
+    std::chrono::nanoseconds pipelinedElapsed{0};
+};
+
+boost::asio::awaitable<void> runRequests(XStationClient &client, Measurement &measurement)
+{
+    co_await client.login();
+
+    // Latency, one request at a time
+    for (std::size_t i = 0; i < warmupRequests + measuredRequests; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        co_await client.getServerTime();
+        if (i >= warmupRequests)
+        {
+            measurement.latencies.push_back(std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    // Throughput, requestsInFlight requests pipelined on the connection
+    const auto executor = co_await boost::asio::this_coro::executor;
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t completed = 0;
+    for (std::size_t worker = 0; worker < requestsInFlight; ++worker)
+    {
+        boost::asio::co_spawn(
+            executor,
+            [&client, &completed]() -> boost::asio::awaitable<void> {
+                for (std::size_t i = 0; i < measuredRequests / requestsInFlight; ++i)
+                {
+                    co_await client.getServerTime();
+                }
+                ++completed;
+            },
+            boost::asio::detached);
+    }
+    boost::asio::steady_timer timer(executor);
+    while (completed < requestsInFlight)
+    {
+        timer.expires_after(std::chrono::microseconds(100));
+        co_await timer.async_wait(boost::asio::use_awaitable);
+    }
+    measurement.pipelinedElapsed = std::chrono::steady_clock::now() - start;
+}
+
+template <typename Server> void measure(const std::string &name, const Server &server)
+{
+    ConnectionOptions options;
+    options.endpoint.tls = Server::tls;
+    options.endpoint.host = "127.0.0.1";
+    options.endpoint.port = server.port();
+    // The xAPI request limit would dominate the measurement
+    options.rateLimiter = std::make_shared<RateLimiter>(std::chrono::nanoseconds(0));
+
+    boost::asio::io_context ioContext;
+    XStationClient client(ioContext, "benchmark", "benchmark", "demo", options);
+    Measurement measurement;
+    measurement.latencies.reserve(measuredRequests);
+    boost::asio::co_spawn(client.getStrand(), runRequests(client, measurement), [](std::exception_ptr eptr) {
+        if (eptr)
+        {
+            std::rethrow_exception(eptr);
+        }
+    });
+    ioContext.run();
+
+    auto &latencies = measurement.latencies;
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double fraction) {
+        const auto index = static_cast<std::size_t>(fraction * static_cast<double>(latencies.size() - 1));
+        return std::chrono::duration<double, std::micro>(latencies[index]).count();
+    };
+    const double requestsPerSecond = static_cast<double>(measuredRequests / requestsInFlight * requestsInFlight) /
+                                     std::chrono::duration<double>(measurement.pipelinedElapsed).count();
+
+    std::cout << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << percentile(0.5) << " us p50" << std::setw(10) << percentile(0.99) << " us p99"
+              << std::setw(12) << std::setprecision(0) << requestsPerSecond << " req/s pipelined" << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    benchmark::PlainBenchmarkServer plainServer(answerCommands<benchmark::PlainServerWebsocket>);
+    measure("ws://", plainServer);
+
+    benchmark::BenchmarkServer tlsServer(answerCommands<benchmark::ServerWebsocket>);
+    measure("wss://", tlsServer);
+
+    std::cout << "Requests: " << measuredRequests << " getServerTime one at a time, then " << requestsInFlight
+              << " in flight" << std::endl;
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file CommandSerializationBenchmark.cpp
+ * @brief Heap allocations and time per serialized command.
+ *
+ * Compares boost::json::serialize into a fresh std::string with internals::CommandSerializer writing
+ * into a reused buffer, for the getTickPrices and tradeTransaction commands. Both paths are measured
+ * with and without building the boost::json::object, and against rendering the command from an
+ * internals::CommandTemplate, as XStationClient does for every call.
+ */
+
+#include "AllocationCounter.hpp"
+#include "xapi/CommandSerializer.hpp"
+#include "xapi/CommandTemplate.hpp"
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace xapi;
+
+namespace
+{
+
+constexpr std::size_t iterations = 1000000;
+
+constexpr internals::CommandTemplate<3> tickPricesTemplate(
+    R"({"command":"getTickPrices","arguments":{"symbols":?,"timestamp":?,"level":?}})");
+constexpr internals::CommandTemplate<11> tradeTransactionTemplate(
+    R"({"command":"tradeTransaction","arguments":{"tradeTransInfo":{"cmd":?,"customComment":?,"expiration":?,)"
+    R"("offset":?,"order":?,"price":?,"sl":?,"symbol":?,"tp":?,"type":?,"volume":?}}})");
+
+boost::json::object makeTickPricesCommand(const std::vector<std::string> &symbols)
+{
+    return {
+        {"command", "getTickPrices"},
+        {"arguments", {
+            {"symbols", boost::json::array(symbols.begin(), symbols.end())},
+            {"timestamp", 1262944112000},
+            {"level", 0}
+        }}
+    };
+}
+
+boost::json::object makeTradeTransactionCommand()
+{
+    return {
+        {"command", "tradeTransaction"},
+        {"arguments", {
+            {"tradeTransInfo", {
+                {"cmd", 0},
+                {"customComment", "Some text"},
+                {"expiration", 1462006335000},
+                {"offset", 0},
+                {"order", 82188055},
+                {"price", 1.12f},
+                {"sl", 0.0f},
+                {"symbol", "EURUSD"},
+                {"tp", 0.0f},
+                {"type", 0},
+                {"volume", 5.0f}
+            }}
+        }}
+    };
+}
+
+void measure(const std::string &name, const std::function<void()> &body)
+{
+    // Warm up, lets reused buffers reach their final capacity
+    body();
+
+    const auto allocationsBefore = benchmark::allocationCount();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        body();
+    }
+    const std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    const auto allocations = benchmark::allocationCount() - allocationsBefore;
+
+    std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << static_cast<double>(allocations) / iterations << " allocs/op" << std::setw(10)
+              << static_cast<double>(elapsed.count()) / iterations << " ns/op" << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    const std::vector<std::string> symbols = {"EURUSD", "EURPLN", "US500"};
+    const auto tickPricesCommand = makeTickPricesCommand(symbols);
+    const auto tradeTransactionCommand = makeTradeTransactionCommand();
+
+    internals::CommandSerializer serializer;
+    std::string buffer;
+    std::size_t sink = 0;
+
+    measure("getTickPrices: serialize", [&]() { sink += boost::json::serialize(tickPricesCommand).size(); });
+    measure("getTickPrices: CommandSerializer", [&]() {
+        serializer.serialize(tickPricesCommand, buffer);
+        sink += buffer.size();
+    });
+    measure("getTickPrices: build + serialize",
+            [&]() { sink += boost::json::serialize(makeTickPricesCommand(symbols)).size(); });
+    measure("getTickPrices: build + CommandSerializer", [&]() {
+        serializer.serialize(makeTickPricesCommand(symbols), buffer);
+        sink += buffer.size();
+    });
+    measure("getTickPrices: CommandTemplate", [&]() {
+        tickPricesTemplate.render(buffer, symbols, std::int64_t{1262944112000}, 0);
+        sink += buffer.size();
+    });
+
+    measure("tradeTransaction: serialize", [&]() { sink += boost::json::serialize(tradeTransactionCommand).size(); });
+    measure("tradeTransaction: CommandSerializer", [&]() {
+        serializer.serialize(tradeTransactionCommand, buffer);
+        sink += buffer.size();
+    });
+    measure("tradeTransaction: build + serialize",
+            [&]() { sink += boost::json::serialize(makeTradeTransactionCommand()).size(); });
+    measure("tradeTransaction: build + CommandSerializer", [&]() {
+        serializer.serialize(makeTradeTransactionCommand(), buffer);
+        sink += buffer.size();
+    });
+    measure("tradeTransaction: CommandTemplate", [&]() {
+        tradeTransactionTemplate.render(buffer, 0, "Some text", std::int64_t{1462006335000}, 0, 82188055, 1.12f, 0.0f,
+                                        "EURUSD", 0.0f, 0, 5.0f);
+        sink += buffer.size();
+    });
+
+    // Keeps the serialized output observable
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file CompressionBenchmark.cpp
+ * @brief Bytes on the wire and client CPU time per bulk response, with and without permessage-deflate.
+ *
+ * The server stand-in answers every request with a getAllSymbols-like response of a few megabytes.
+ * Bytes on the wire are the bytes the server's TCP socket got acknowledged (TCP_INFO, Linux only),
+ * so they include TLS and WebSocket framing. CPU time is the time of the client thread, which
+ * receives, inflates and parses the responses; the server runs on its own thread.
+ */
+
+#include "BenchmarkServer.hpp"
+#include "xapi/Connection.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+using namespace xapi;
+
+namespace
+{
+
+constexpr std::size_t warmupResponses = 2;
+constexpr std::size_t measuredResponses = 20;
+constexpr std::size_t symbolCount = 5000;
+
+std::atomic<std::uint64_t> bytesOnWire = 0;
+
+// Builds a response shaped like the one of getAllSymbols.
+std::string makeAllSymbolsResponse()
+{
+    boost::json::array symbols;
+    for (std::size_t i = 0; i < symbolCount; ++i)
+    {
+        const std::string symbol = "SYM" + std::to_string(i) + ".US";
+        symbols.push_back({{"symbol", symbol},
+                           {"currency", "USD"},
+                           {"categoryName", "STC"},
+                           {"currencyProfit", "USD"},
+                           {"quoteId", 5},
+                           {"quoteIdCross", 4},
+                           {"marginMode", 104},
+                           {"profitMode", 6},
+                           {"pipsPrecision", 2},
+                           {"contractSize", 1},
+                           {"exemode", 1},
+                           {"time", 1725545999000 + static_cast<std::int64_t>(i)},
+                           {"expiration", nullptr},
+                           {"stopsLevel", 0},
+                           {"precision", 2},
+                           {"swapType", 2},
+                           {"stepRuleId", 5},
+                           {"type", 2817},
+                           {"instantMaxVolume", 2147483647},
+                           {"groupName", "US"},
+                           {"description", "Company " + std::to_string(i) + " Inc. (common stock)"},
+                           {"longOnly", false},
+                           {"trailingEnabled", true},
+                           {"marginHedgedStrong", false},
+                           {"swapEnable", true},
+                           {"percentage", 100.0},
+                           {"bid", 100.0 + static_cast<double>(i % 997) / 100.0},
+                           {"ask", 100.05 + static_cast<double>(i % 997) / 100.0},
+                           {"high", 105.0},
+                           {"low", 95.0},
+                           {"lotMin", 1.0},
+                           {"lotMax", 100000.0},
+                           {"lotStep", 1.0},
+                           {"tickSize", 0.01},
+                           {"tickValue", 0.01},
+                           {"swapLong", -0.0123},
+                           {"swapShort", -0.0045},
+                           {"leverage", 20.0},
+                           {"spreadRaw", 0.05},
+                           {"spreadTable", 5.0},
+                           {"starting", nullptr},
+                           {"swap_rollover3days", 0},
+                           {"marginMaintenance", 0},
+                           {"marginHedged", 0},
+                           {"initialMargin", 0},
+                           {"timeString", "Thu Sep 05 16:59:59 CEST 2024"},
+                           {"shortSelling", true},
+                           {"currencyPair", false}});
+    }
+    return boost::json::serialize(boost::json::object{{"status", true}, {"returnData", symbols}});
+}
+
+std::chrono::nanoseconds threadCpuTime()
+{
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+std::uint64_t acknowledgedBytes(boost::asio::ip::tcp::socket &socket)
+{
+#if defined(__linux__)
+    tcp_info info{};
+    socklen_t length = sizeof(info);
+    if (getsockopt(socket.native_handle(), IPPROTO_TCP, TCP_INFO, &info, &length) == 0)
+    {
+        return info.tcpi_bytes_acked;
+    }
+#endif
+    return 0;
+}
+
+struct Measurement
+{
+    std::chrono::nanoseconds cpuTime{0};
+    std::chrono::nanoseconds elapsed{0};
+};
+
+boost::asio::awaitable<void> requestRepeatedly(internals::Connection &connection, const boost::url &url,
+                                               Measurement &measurement)
+{
+    co_await connection.connect(url);
+    for (std::size_t i = 0; i < warmupResponses + measuredResponses; ++i)
+    {
+        if (i == warmupResponses)
+        {
+            measurement.cpuTime = threadCpuTime();
+            measurement.elapsed = std::chrono::steady_clock::now().time_since_epoch();
+        }
+        co_await connection.sendMessage(R"({"command":"getAllSymbols"})");
+        co_await connection.waitResponse();
+    }
+    measurement.cpuTime = threadCpuTime() - measurement.cpuTime;
+    measurement.elapsed = std::chrono::steady_clock::now().time_since_epoch() - measurement.elapsed;
+    co_await connection.disconnect();
+}
+
+void measure(const std::string &name, const boost::url &url, ConnectionOptions options)
+{
+    options.rateLimiter = std::make_shared<RateLimiter>(std::chrono::nanoseconds(0));
+
+    boost::asio::io_context ioContext;
+    internals::Connection connection(ioContext, options);
+    Measurement measurement;
+    boost::asio::co_spawn(ioContext, requestRepeatedly(connection, url, measurement), [](std::exception_ptr eptr) {
+        if (eptr)
+        {
+            std::rethrow_exception(eptr);
+        }
+    });
+    ioContext.run();
+
+    // The server publishes its byte count once it saw the close frame
+    std::uint64_t bytes = 0;
+    while ((bytes = bytesOnWire.exchange(0)) == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << static_cast<double>(bytes) / (warmupResponses + measuredResponses) / 1024.0
+              << " KiB/resp" << std::setw(10)
+              << std::chrono::duration<double, std::milli>(measurement.cpuTime).count() / measuredResponses
+              << " ms CPU/resp" << std::setw(10)
+              << std::chrono::duration<double, std::milli>(measurement.elapsed).count() / measuredResponses
+              << " ms/resp" << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    const std::string response = makeAllSymbolsResponse();
+
+    boost::beast::websocket::permessage_deflate serverDeflate;
+    serverDeflate.server_enable = true;
+    serverDeflate.compLevel = 6;
+
+    benchmark::BenchmarkServer server(
+        [&response](benchmark::ServerWebsocket &websocket) -> boost::asio::awaitable<void> {
+            auto &socket = boost::beast::get_lowest_layer(websocket).socket();
+            boost::beast::flat_buffer buffer;
+            try
+            {
+                for (;;)
+                {
+                    co_await websocket.async_read(buffer, boost::asio::use_awaitable);
+                    buffer.clear();
+                    co_await websocket.async_write(boost::asio::buffer(response), boost::asio::use_awaitable);
+                }
+            }
+            catch (const boost::system::system_error &)
+            {
+                // Client closed the connection
+            }
+            bytesOnWire = std::max<std::uint64_t>(acknowledgedBytes(socket), 1);
+        },
+        serverDeflate);
+
+    ConnectionOptions plain;
+    measure("uncompressed", server.url(), plain);
+
+    for (const int windowBits : {15, 12, 9})
+    {
+        ConnectionOptions compressed;
+        compressed.compression.enabled = true;
+        compressed.compression.serverMaxWindowBits = windowBits;
+        measure("deflate, window " + std::to_string(windowBits) + " bits", server.url(), compressed);
+    }
+
+    ConnectionOptions noContextTakeover;
+    noContextTakeover.compression.enabled = true;
+    noContextTakeover.compression.serverNoContextTakeover = true;
+    measure("deflate, no context takeover", server.url(), noContextTakeover);
+
+    std::cout << "Responses: " << measuredResponses << " x " << response.size() / 1024
+              << " KiB of JSON, bytes include TLS and WebSocket framing" << std::endl;
+    return 0;
+}
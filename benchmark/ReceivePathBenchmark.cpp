@@ -0,0 +1,174 @@
+/**
+ * @file ReceivePathBenchmark.cpp
+ * @brief Heap allocations and time per received message in Connection::waitResponse.
+ *
+ * The server stand-in streams tick messages as fast as it can. The client receives them through
+ * internals::Connection and reports allocations per message. The receive paths used before (fresh
+ * flat_buffer + buffers_to_string + parse, then parse in place) are replayed in-process on the same
+ * payload for reference.
+ */
+
+#include "AllocationCounter.hpp"
+#include "BenchmarkServer.hpp"
+#include "xapi/Connection.hpp"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using namespace xapi;
+
+namespace
+{
+
+constexpr std::size_t warmupMessages = 1000;
+constexpr std::size_t measuredMessages = 100000;
+
+const std::string tickMessage =
+    R"({"command":"tickPrices","data":{"ask":4000.0,"askVolume":15000,"bid":4000.0,"bidVolume":16000,)"
+    R"("high":4000.0,"level":0,"low":3500.0,"quoteId":0,"spreadRaw":0.000003,"spreadTable":0.00042,)"
+    R"("symbol":"KOMB.CZ","timestamp":1272529161605}})";
+
+struct Measurement
+{
+    std::size_t allocations = 0;
+    std::chrono::nanoseconds elapsed{0};
+};
+
+void report(const std::string &name, const Measurement &measurement)
+{
+    std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << static_cast<double>(measurement.allocations) / measuredMessages << " allocs/msg"
+              << std::setw(12) << static_cast<double>(measurement.elapsed.count()) / measuredMessages << " ns/msg"
+              << std::endl;
+}
+
+// Replays the receive path that allocated a new buffer and an intermediate string per message.
+Measurement measureFreshBufferParse()
+{
+    Measurement measurement;
+    const auto allocationsBefore = benchmark::allocationCount();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < measuredMessages; ++i)
+    {
+        boost::beast::flat_buffer buffer;
+        auto writable = buffer.prepare(tickMessage.size());
+        std::memcpy(writable.data(), tickMessage.data(), tickMessage.size());
+        buffer.commit(tickMessage.size());
+
+        auto dataString = boost::beast::buffers_to_string(buffer.data());
+        buffer.consume(buffer.size());
+        boost::json::object jsonData = boost::json::parse(dataString).as_object();
+        static_cast<void>(jsonData);
+    }
+    measurement.elapsed = std::chrono::steady_clock::now() - start;
+    measurement.allocations = benchmark::allocationCount() - allocationsBefore;
+    return measurement;
+}
+
+// Replays the persistent buffer parsed in place with boost::json::parse.
+Measurement measureReusedBufferParse()
+{
+    Measurement measurement;
+    boost::beast::flat_buffer buffer;
+    const auto allocationsBefore = benchmark::allocationCount();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < measuredMessages; ++i)
+    {
+        buffer.clear();
+        auto writable = buffer.prepare(tickMessage.size());
+        std::memcpy(writable.data(), tickMessage.data(), tickMessage.size());
+        buffer.commit(tickMessage.size());
+
+        const auto frame = buffer.cdata();
+        boost::json::value jsonValue =
+            boost::json::parse(std::string_view(static_cast<const char *>(frame.data()), frame.size()));
+        static_cast<void>(jsonValue);
+    }
+    measurement.elapsed = std::chrono::steady_clock::now() - start;
+    measurement.allocations = benchmark::allocationCount() - allocationsBefore;
+    return measurement;
+}
+
+// Replays the current receive path: persistent buffer, persistent stream_parser and per-message arena.
+Measurement measureArenaParse()
+{
+    Measurement measurement;
+    boost::beast::flat_buffer buffer;
+    boost::json::stream_parser parser;
+    const auto allocationsBefore = benchmark::allocationCount();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < measuredMessages; ++i)
+    {
+        buffer.clear();
+        auto writable = buffer.prepare(tickMessage.size());
+        std::memcpy(writable.data(), tickMessage.data(), tickMessage.size());
+        buffer.commit(tickMessage.size());
+
+        const auto frame = buffer.cdata();
+        parser.reset(boost::json::make_shared_resource<boost::json::monotonic_resource>(frame.size() * 2));
+        parser.write(static_cast<const char *>(frame.data()), frame.size());
+        parser.finish();
+        boost::json::value jsonValue = parser.release();
+        static_cast<void>(jsonValue);
+    }
+    measurement.elapsed = std::chrono::steady_clock::now() - start;
+    measurement.allocations = benchmark::allocationCount() - allocationsBefore;
+    return measurement;
+}
+
+boost::asio::awaitable<void> receiveMessages(internals::Connection &connection, const boost::url &url,
+                                             Measurement &measurement)
+{
+    co_await connection.connect(url);
+
+    for (std::size_t i = 0; i < warmupMessages; ++i)
+    {
+        co_await connection.waitResponse();
+    }
+
+    const auto allocationsBefore = benchmark::allocationCount();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < measuredMessages; ++i)
+    {
+        co_await connection.waitResponse();
+    }
+    measurement.elapsed = std::chrono::steady_clock::now() - start;
+    measurement.allocations = benchmark::allocationCount() - allocationsBefore;
+
+    co_await connection.disconnect();
+}
+
+} // namespace
+
+int main()
+{
+    benchmark::BenchmarkServer server([](benchmark::ServerWebsocket &websocket) -> boost::asio::awaitable<void> {
+        for (std::size_t i = 0; i < warmupMessages + measuredMessages; ++i)
+        {
+            co_await websocket.async_write(boost::asio::buffer(tickMessage), boost::asio::use_awaitable);
+        }
+        // Wait for the client to close the connection
+        boost::beast::flat_buffer buffer;
+        co_await websocket.async_read(buffer, boost::asio::use_awaitable);
+    });
+
+    boost::asio::io_context ioContext;
+    internals::Connection connection(ioContext);
+    Measurement endToEnd;
+    boost::asio::co_spawn(ioContext, receiveMessages(connection, server.url(), endToEnd),
+                          [](std::exception_ptr eptr) {
+                              if (eptr)
+                              {
+                                  std::rethrow_exception(eptr);
+                              }
+                          });
+    ioContext.run();
+
+    std::cout << "Messages: " << measuredMessages << ", payload: " << tickMessage.size() << " bytes" << std::endl;
+    report("parse, fresh buffer + string", measureFreshBufferParse());
+    report("parse, reused buffer in place", measureReusedBufferParse());
+    report("stream_parser + arena", measureArenaParse());
+    report("Connection::waitResponse", endToEnd);
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file SocketOptionsBenchmark.cpp
+ * @brief Request round-trip time over loopback with different SocketOptions.
+ *
+ * Every iteration sends two small commands back to back and waits for the answer, which the
+ * server sends once both arrived. This write-write-read pattern is the one in which Nagle's
+ * algorithm holds the second command until the first one is acknowledged, and the server
+ * delays that acknowledgement. The server itself always runs with TCP_NODELAY, so only the
+ * options of the client side are compared.
+ */
+
+#include "BenchmarkServer.hpp"
+#include "xapi/Connection.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace xapi;
+
+namespace
+{
+
+constexpr std::size_t warmupRoundTrips = 20;
+constexpr std::size_t measuredRoundTrips = 2000;
+
+const std::string firstCommand = R"({"command":"tradeTransaction","arguments":{"tradeTransInfo":{"cmd":0,"symbol":"EURUSD","volume":0.1}}})";
+const std::string secondCommand = R"({"command":"tradeTransactionStatus","arguments":{"order":1}})";
+
+void report(const std::string &name, std::vector<std::chrono::nanoseconds> roundTripTimes)
+{
+    std::sort(roundTripTimes.begin(), roundTripTimes.end());
+    const auto percentile = [&roundTripTimes](double fraction) {
+        const auto index = static_cast<std::size_t>(fraction * static_cast<double>(roundTripTimes.size() - 1));
+        return std::chrono::duration<double, std::micro>(roundTripTimes[index]).count();
+    };
+
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << percentile(0.5) << " us p50" << std::setw(10) << percentile(0.99) << " us p99"
+              << std::setw(10) << percentile(1.0) << " us max" << std::endl;
+}
+
+boost::asio::awaitable<void> roundTrips(internals::Connection &connection, const boost::url &url,
+                                        std::vector<std::chrono::nanoseconds> &roundTripTimes)
+{
+    co_await connection.connect(url);
+    for (std::size_t i = 0; i < warmupRoundTrips + measuredRoundTrips; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        co_await connection.sendMessage(firstCommand);
+        co_await connection.sendMessage(secondCommand);
+        co_await connection.waitResponse();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if (i >= warmupRoundTrips)
+        {
+            roundTripTimes.push_back(elapsed);
+        }
+    }
+    co_await connection.disconnect();
+}
+
+std::vector<std::chrono::nanoseconds> measure(const boost::url &url, ConnectionOptions options)
+{
+    // The xAPI request limit would dominate the round trip
+    options.rateLimiter = std::make_shared<RateLimiter>(std::chrono::nanoseconds(0));
+
+    boost::asio::io_context ioContext;
+    internals::Connection connection(ioContext, options);
+    std::vector<std::chrono::nanoseconds> roundTripTimes;
+    roundTripTimes.reserve(measuredRoundTrips);
+    boost::asio::co_spawn(ioContext, roundTrips(connection, url, roundTripTimes), [](std::exception_ptr eptr) {
+        if (eptr)
+        {
+            std::rethrow_exception(eptr);
+        }
+    });
+    ioContext.run();
+    return roundTripTimes;
+}
+
+} // namespace
+
+int main()
+{
+    benchmark::BenchmarkServer server([](benchmark::ServerWebsocket &websocket) -> boost::asio::awaitable<void> {
+        boost::beast::get_lowest_layer(websocket).socket().set_option(boost::asio::ip::tcp::no_delay(true));
+        boost::beast::flat_buffer buffer;
+        for (;;)
+        {
+            co_await websocket.async_read(buffer, boost::asio::use_awaitable);
+            co_await websocket.async_read(buffer, boost::asio::use_awaitable);
+            buffer.clear();
+            co_await websocket.async_write(boost::asio::buffer(std::string_view(R"({"status":true})")),
+                                           boost::asio::use_awaitable);
+        }
+    });
+
+    ConnectionOptions nagle;
+    nagle.socket.noDelay = false;
+    report("Nagle (noDelay = false)", measure(server.url(), nagle));
+
+    ConnectionOptions noDelay;
+    report("noDelay", measure(server.url(), noDelay));
+
+    ConnectionOptions quickAck;
+    quickAck.socket.quickAck = true;
+    report("noDelay + quickAck", measure(server.url(), quickAck));
+
+    ConnectionOptions buffers;
+    buffers.socket.quickAck = true;
+    buffers.socket.receiveBufferSize = 256 * 1024;
+    buffers.socket.sendBufferSize = 256 * 1024;
+    report("noDelay + quickAck + 256K", measure(server.url(), buffers));
+
+    ConnectionOptions busyPoll;
+    busyPoll.socket.quickAck = true;
+    busyPoll.socket.busyPoll = 50;
+    report("noDelay + quickAck + busyPoll", measure(server.url(), busyPoll));
+
+    std::cout << "Round trips: " << measuredRoundTrips << ", two commands sent back to back per round trip"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file StreamReplayBenchmark.cpp
+ * @brief Throughput and latency of many streams receiving replayed tick prices over loopback.
+ *
+ * A few hundred XStationClientStream connections subscribe to one symbol each, and the server
+ * stand-in replays a fixed number of tickPrices messages on every connection as fast as it can.
+ * Every message carries the time it was written, so the latency includes the time it waited in
+ * socket buffers and in the event loop of the client. Client and server run on one thread each.
+ *
+ * The reactor is chosen at build time: configure once with and once without XAPI_USE_IO_URING
+ * to compare io_uring with epoll. The benchmark prints the backend it was built with.
+ */
+
+#include "BenchmarkServer.hpp"
+#include "xapi/XStationClientStream.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace xapi;
+
+namespace
+{
+
+constexpr std::size_t streamCount = 256;
+constexpr std::size_t messagesPerStream = 2000;
+
+constexpr const char *backend()
+{
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+    return "io_uring";
+#elif defined(BOOST_ASIO_HAS_EPOLL)
+    return "epoll";
+#else
+    return "other";
+#endif
+}
+
+std::int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+boost::asio::awaitable<void> replayTickPrices(benchmark::PlainServerWebsocket &websocket)
+{
+    boost::beast::flat_buffer buffer;
+    co_await websocket.async_read(buffer, boost::asio::use_awaitable);
+    const auto command = boost::json::parse(boost::beast::buffers_to_string(buffer.data())).as_object();
+    const std::string symbol(command.at("symbol").as_string());
+
+    std::string message;
+    for (std::size_t i = 0; i < messagesPerStream; ++i)
+    {
+        message = R"({"command":"tickPrices","data":{"symbol":")" + symbol +
+                  R"(","ask":1.08412,"bid":1.08405,"askVolume":1000000,"bidVolume":1000000,"level":0,"quoteId":2,"sent":)" +
+                  std::to_string(now()) + "}}";
+        co_await websocket.async_write(boost::asio::buffer(message), boost::asio::use_awaitable);
+    }
+
+    // Wait for the client to close the connection
+    co_await websocket.async_read(buffer, boost::asio::use_awaitable);
+}
+
+boost::asio::awaitable<void> receiveTickPrices(XStationClientStream &stream, std::size_t index,
+                                               std::vector<std::chrono::nanoseconds> &latencies,
+                                               std::size_t &completed)
+{
+    co_await stream.getTickPrices("SYM" + std::to_string(index));
+    for (std::size_t i = 0; i < messagesPerStream; ++i)
+    {
+        const auto message = co_await stream.listen();
+        const std::int64_t sent = message.at("data").at("sent").as_int64();
+        latencies.push_back(std::chrono::nanoseconds(now() - sent));
+    }
+    ++completed;
+}
+
+struct Measurement
+{
+    std::vector<std::chrono::nanoseconds> latencies;
+    std::chrono::nanoseconds elapsed{0};
+};
+
+boost::asio::awaitable<void> runStreams(boost::asio::io_context &ioContext, const ConnectionOptions &options,
+                                        Measurement &measurement)
+{
+    std::vector<std::unique_ptr<XStationClientStream>> streams;
+    for (std::size_t i = 0; i < streamCount; ++i)
+    {
+        streams.push_back(std::make_unique<XStationClientStream>(ioContext, "demo", "benchmark", options));
+        co_await streams.back()->open();
+    }
+
+    const auto executor = co_await boost::asio::this_coro::executor;
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t completed = 0;
+    for (std::size_t i = 0; i < streamCount; ++i)
+    {
+        boost::asio::co_spawn(streams[i]->getStrand(),
+                              receiveTickPrices(*streams[i], i, measurement.latencies, completed),
+                              boost::asio::detached);
+    }
+    boost::asio::steady_timer timer(executor);
+    while (completed < streamCount)
+    {
+        timer.expires_after(std::chrono::microseconds(100));
+        co_await timer.async_wait(boost::asio::use_awaitable);
+    }
+    measurement.elapsed = std::chrono::steady_clock::now() - start;
+
+    for (auto &stream : streams)
+    {
+        co_await stream->close();
+    }
+}
+
+} // namespace
+
+int main()
+{
+    benchmark::PlainBenchmarkServer server(replayTickPrices);
+
+    ConnectionOptions options;
+    options.endpoint.tls = false;
+    options.endpoint.host = "127.0.0.1";
+    options.endpoint.port = server.port();
+    // Only the subscription is sent, but the xAPI request limit would serialize the streams
+    options.rateLimiter = std::make_shared<RateLimiter>(std::chrono::nanoseconds(0));
+
+    // One thread, so the streams need not synchronize on the latencies
+    boost::asio::io_context ioContext(1);
+    Measurement measurement;
+    measurement.latencies.reserve(streamCount * messagesPerStream);
+    boost::asio::co_spawn(ioContext, runStreams(ioContext, options, measurement), [](std::exception_ptr eptr) {
+        if (eptr)
+        {
+            std::rethrow_exception(eptr);
+        }
+    });
+    ioContext.run();
+
+    auto &latencies = measurement.latencies;
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double fraction) {
+        const auto index = static_cast<std::size_t>(fraction * static_cast<double>(latencies.size() - 1));
+        return std::chrono::duration<double, std::micro>(latencies[index]).count();
+    };
+    const double messagesPerSecond =
+        static_cast<double>(latencies.size()) / std::chrono::duration<double>(measurement.elapsed).count();
+
+    std::cout << std::left << std::setw(10) << backend() << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << messagesPerSecond << " msg/s" << std::setprecision(1) << std::setw(10)
+              << percentile(0.5) << " us p50" << std::setw(10) << percentile(0.99) << " us p99" << std::setw(10)
+              << percentile(0.999) << " us p99.9" << std::endl;
+    std::cout << "Streams: " << streamCount << " x " << messagesPerStream << " tickPrices messages" << std::endl;
+    return 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file TlsResumptionBenchmark.cpp
+ * @brief Connection setup time with and without TLS session resumption.
+ *
+ * Every iteration opens a new internals::Connection to the local server stand-in and closes it again,
+ * the way the stream connection of a client or a reconnect does. Connections run once with full
+ * handshakes only and once with a TlsSessionCache. The server counts the handshakes it resumed.
+ */
+
+#include "BenchmarkServer.hpp"
+#include "xapi/Connection.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace xapi;
+
+namespace
+{
+
+constexpr std::size_t warmupConnections = 10;
+constexpr std::size_t measuredConnections = 500;
+
+std::atomic<std::size_t> resumedHandshakes = 0;
+
+void report(const std::string &name, std::vector<std::chrono::nanoseconds> connectTimes)
+{
+    std::sort(connectTimes.begin(), connectTimes.end());
+    const auto percentile = [&connectTimes](double fraction) {
+        const auto index = static_cast<std::size_t>(fraction * static_cast<double>(connectTimes.size() - 1));
+        return std::chrono::duration<double, std::micro>(connectTimes[index]).count();
+    };
+
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << percentile(0.5) << " us p50" << std::setw(10) << percentile(0.99) << " us p99"
+              << std::setw(8) << resumedHandshakes.exchange(0) << "/" << warmupConnections + measuredConnections
+              << " resumed" << std::endl;
+}
+
+boost::asio::awaitable<void> connectRepeatedly(boost::asio::io_context &ioContext, const boost::url &url,
+                                               const ConnectionOptions &options,
+                                               std::vector<std::chrono::nanoseconds> &connectTimes)
+{
+    for (std::size_t i = 0; i < warmupConnections + measuredConnections; ++i)
+    {
+        internals::Connection connection(ioContext, options);
+
+        const auto start = std::chrono::steady_clock::now();
+        co_await connection.connect(url);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        co_await connection.disconnect();
+        if (i >= warmupConnections)
+        {
+            connectTimes.push_back(elapsed);
+        }
+    }
+}
+
+std::vector<std::chrono::nanoseconds> measure(const boost::url &url, const ConnectionOptions &options)
+{
+    boost::asio::io_context ioContext;
+    std::vector<std::chrono::nanoseconds> connectTimes;
+    connectTimes.reserve(measuredConnections);
+    boost::asio::co_spawn(ioContext, connectRepeatedly(ioContext, url, options, connectTimes),
+                          [](std::exception_ptr eptr) {
+                              if (eptr)
+                              {
+                                  std::rethrow_exception(eptr);
+                              }
+                          });
+    ioContext.run();
+    return connectTimes;
+}
+
+} // namespace
+
+int main()
+{
+    benchmark::BenchmarkServer server([](benchmark::ServerWebsocket &websocket) -> boost::asio::awaitable<void> {
+        if (SSL_session_reused(websocket.next_layer().native_handle()))
+        {
+            ++resumedHandshakes;
+        }
+        // Wait for the client to close the connection
+        boost::beast::flat_buffer buffer;
+        co_await websocket.async_read(buffer, boost::asio::use_awaitable);
+    });
+
+    ConnectionOptions fullHandshakes;
+    fullHandshakes.tlsSessionCache = nullptr;
+    const auto fullHandshakeTimes = measure(server.url(), fullHandshakes);
+    report("full handshake", fullHandshakeTimes);
+
+    ConnectionOptions resumedSessions;
+    resumedSessions.tlsSessionCache = std::make_shared<TlsSessionCache>();
+    const auto resumedSessionTimes = measure(server.url(), resumedSessions);
+    report("TlsSessionCache", resumedSessionTimes);
+
+    std::cout << "Connections: " << measuredConnections << ", connect() = TCP + TLS + WebSocket handshake"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file WriteCoalescingBenchmark.cpp
+ * @brief Time and TCP segments per burst of subscription commands, with and without coalesced writes.
+ *
+ * Every burst queues a few hundred getTickPrices subscriptions on the connection at once, the way
+ * a stream subscribes on startup or replays its subscriptions after a reconnect. The server stand-in
+ * acknowledges a burst once it read all its commands. Segments are the segments the server's TCP
+ * socket received (TCP_INFO, Linux only), i.e. roughly the client's write system calls and, over
+ * TLS, its TLS records.
+ */
+
+#include "BenchmarkServer.hpp"
+#include "xapi/Connection.hpp"
+#include <boost/asio/experimental/parallel_group.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+using namespace xapi;
+
+namespace
+{
+
+constexpr std::size_t burstSize = 200;
+constexpr std::size_t warmupBursts = 2;
+constexpr std::size_t measuredBursts = 20;
+
+std::atomic<std::uint64_t> segmentsIn = 0;
+
+std::uint64_t receivedSegments(boost::asio::ip::tcp::socket &socket)
+{
+#if defined(__linux__)
+    tcp_info info{};
+    socklen_t length = sizeof(info);
+    if (getsockopt(socket.native_handle(), IPPROTO_TCP, TCP_INFO, &info, &length) == 0)
+    {
+        return info.tcpi_segs_in;
+    }
+#endif
+    return 0;
+}
+
+template <typename Websocket> boost::asio::awaitable<void> acknowledgeBursts(Websocket &websocket)
+{
+    auto &socket = boost::beast::get_lowest_layer(websocket).socket();
+    boost::beast::flat_buffer buffer;
+    try
+    {
+        for (;;)
+        {
+            for (std::size_t i = 0; i < burstSize; ++i)
+            {
+                co_await websocket.async_read(buffer, boost::asio::use_awaitable);
+                buffer.clear();
+            }
+            co_await websocket.async_write(boost::asio::buffer(std::string_view(R"({"status":true})")),
+                                           boost::asio::use_awaitable);
+        }
+    }
+    catch (const boost::system::system_error &)
+    {
+        // Client closed the connection
+    }
+    segmentsIn = std::max<std::uint64_t>(receivedSegments(socket), 1);
+}
+
+boost::asio::awaitable<void> sendBurst(internals::Connection &connection, const std::vector<std::string> &commands)
+{
+    const auto executor = co_await boost::asio::this_coro::executor;
+    using Operation = decltype(boost::asio::co_spawn(executor, connection.sendMessage(commands.front()),
+                                                     boost::asio::deferred));
+    std::vector<Operation> operations;
+    operations.reserve(commands.size());
+    for (const auto &command : commands)
+    {
+        operations.push_back(boost::asio::co_spawn(executor, connection.sendMessage(command), boost::asio::deferred));
+    }
+    co_await boost::asio::experimental::make_parallel_group(std::move(operations))
+        .async_wait(boost::asio::experimental::wait_for_all(), boost::asio::use_awaitable);
+}
+
+boost::asio::awaitable<void> sendBursts(internals::Connection &connection, const boost::url &url,
+                                        std::chrono::nanoseconds &elapsed)
+{
+    std::vector<std::string> commands;
+    for (std::size_t i = 0; i < burstSize; ++i)
+    {
+        commands.push_back(R"({"command":"getTickPrices","streamSessionId":"8469308861804289383","symbol":"SYM)" +
+                           std::to_string(i) + R"(","minArrivalTime":0,"maxLevel":2})");
+    }
+
+    co_await connection.connect(url);
+    std::chrono::steady_clock::time_point start;
+    for (std::size_t i = 0; i < warmupBursts + measuredBursts; ++i)
+    {
+        if (i == warmupBursts)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+        co_await sendBurst(connection, commands);
+        co_await connection.waitResponse();
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    co_await connection.disconnect();
+}
+
+void measure(const std::string &name, const boost::url &url, bool coalesceWrites)
+{
+    ConnectionOptions options;
+    options.rateLimiter = std::make_shared<RateLimiter>(std::chrono::nanoseconds(0));
+    options.coalesceWrites = coalesceWrites;
+
+    boost::asio::io_context ioContext;
+    internals::Connection connection(ioContext, options);
+    std::chrono::nanoseconds elapsed{0};
+    boost::asio::co_spawn(ioContext, sendBursts(connection, url, elapsed), [](std::exception_ptr eptr) {
+        if (eptr)
+        {
+            std::rethrow_exception(eptr);
+        }
+    });
+    ioContext.run();
+
+    // The server publishes its segment count once it saw the close frame
+    std::uint64_t segments = 0;
+    while ((segments = segmentsIn.exchange(0)) == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(segments) / (warmupBursts + measuredBursts)
+              << " segments/burst" << std::setw(10)
+              << std::chrono::duration<double, std::micro>(elapsed).count() / measuredBursts << " us/burst"
+              << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    benchmark::BenchmarkServer tlsServer(acknowledgeBursts<benchmark::ServerWebsocket>);
+    benchmark::PlainBenchmarkServer plainServer(acknowledgeBursts<benchmark::PlainServerWebsocket>);
+
+    measure("wss, one write each", tlsServer.url(), false);
+    measure("wss, coalesced", tlsServer.url(), true);
+    measure("ws, one write each", plainServer.url(), false);
+    measure("ws, coalesced", plainServer.url(), true);
+
+    std::cout << "Bursts: " << measuredBursts << " x " << burstSize
+              << " getTickPrices commands, segments include the handshakes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "xapi/CommandSerializer.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace xapi;
+
+TEST(CommandSerializerTest, serialize_matches_boost_json)
+{
+    const boost::json::object command = {
+        {"command", "tradeTransaction"},
+        {"arguments", {
+            {"tradeTransInfo", {
+                {"cmd", 0},
+                {"customComment", "Some \"quoted\" comment"},
+                {"expiration", 1462006335000},
+                {"price", 1.4f},
+                {"symbol", "EURUSD"}
+            }}
+        }}
+    };
+
+    internals::CommandSerializer serializer;
+    std::string buffer;
+    serializer.serialize(command, buffer);
+
+    EXPECT_EQ(buffer, boost::json::serialize(command));
+}
+
+TEST(CommandSerializerTest, serialize_replaces_buffer_content)
+{
+    const boost::json::object longCommand = {
+        {"command", "getTradingHours"},
+        {"arguments", {
+            {"symbols", boost::json::array({"EURUSD", "EURPLN", "EURGBP", "USDJPY", "GBPUSD", "US500"})}
+        }}
+    };
+    const boost::json::object shortCommand = {{"command", "ping"}};
+
+    internals::CommandSerializer serializer;
+    std::string buffer;
+    serializer.serialize(longCommand, buffer);
+    const auto capacity = buffer.capacity();
+
+    serializer.serialize(shortCommand, buffer);
+    EXPECT_EQ(buffer, boost::json::serialize(shortCommand));
+    EXPECT_EQ(buffer.capacity(), capacity);
+}
+
+TEST(CommandSerializerTest, serialize_grows_buffer)
+{
+    boost::json::array symbols;
+    for (int i = 0; i < 1000; ++i)
+    {
+        symbols.emplace_back("SYMBOL" + std::to_string(i));
+    }
+    const boost::json::object command = {
+        {"command", "getTradingHours"},
+        {"arguments", {
+            {"symbols", symbols}
+        }}
+    };
+
+    internals::CommandSerializer serializer;
+    std::string buffer;
+    serializer.serialize(command, buffer);
+
+    EXPECT_EQ(buffer, boost::json::serialize(command));
+}
@@ -0,0 +1,79 @@
+#include "xapi/CommandTemplate.hpp"
+#include <boost/json.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace xapi;
+
+namespace
+{
+
+constexpr internals::CommandTemplate<0> pingCommand(R"({"command":"ping"})");
+constexpr internals::CommandTemplate<3> tickPricesCommand(
+    R"({"command":"getTickPrices","arguments":{"symbols":?,"timestamp":?,"level":?}})");
+constexpr internals::CommandTemplate<4> mixedCommand(
+    R"({"command":"test","streamSessionId":?,"arguments":{"price":?,"openedOnly":?,"orders":?}})");
+
+} // namespace
+
+TEST(CommandTemplateTest, render_without_slots)
+{
+    std::string buffer = "previous content";
+    pingCommand.render(buffer);
+    EXPECT_EQ(buffer, R"({"command":"ping"})");
+}
+
+TEST(CommandTemplateTest, render_matches_json_object)
+{
+    const std::vector<std::string> symbols = {"EURUSD", "EURPLN"};
+    const boost::json::object expectedCommand = {
+        {"command", "getTickPrices"},
+        {"arguments", {
+            {"symbols", boost::json::array(symbols.begin(), symbols.end())},
+            {"timestamp", 1262944112000},
+            {"level", 0}
+        }}
+    };
+
+    std::string buffer;
+    tickPricesCommand.render(buffer, symbols, std::int64_t{1262944112000}, 0);
+    EXPECT_EQ(boost::json::parse(buffer).as_object(), expectedCommand);
+}
+
+TEST(CommandTemplateTest, render_mixed_types)
+{
+    const boost::json::object expectedCommand = {
+        {"command", "test"},
+        {"streamSessionId", "session"},
+        {"arguments", {
+            {"price", 1.0f},
+            {"openedOnly", true},
+            {"orders", boost::json::array({1, 2, 3})}
+        }}
+    };
+
+    std::string buffer;
+    mixedCommand.render(buffer, internals::RawJson{R"("session")"}, 1.0f, true, std::vector<int>{1, 2, 3});
+    EXPECT_EQ(boost::json::parse(buffer).as_object(), expectedCommand);
+}
+
+TEST(CommandTemplateTest, appendJson_escapes_strings)
+{
+    const std::string value = "quote\" backslash\\ newline\n control\x01";
+
+    std::string buffer;
+    internals::appendJson(buffer, value);
+    EXPECT_EQ(boost::json::parse(buffer).as_string(), value);
+}
+
+TEST(CommandTemplateTest, appendJson_floats_stay_doubles)
+{
+    std::string buffer;
+    internals::appendJson(buffer, 5.0f);
+    EXPECT_TRUE(boost::json::parse(buffer).is_double());
+
+    buffer.clear();
+    internals::appendJson(buffer, 1.1f);
+    EXPECT_EQ(boost::json::parse(buffer).as_double(), static_cast<double>(1.1f));
+}
@@ -1,6 +1,9 @@
 #include "xapi/Connection.hpp"
+#include "xapi/Deadline.hpp"
 #include "xapi/Exceptions.hpp"
 #include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -82,12 +85,45 @@ class ConnectionTest : public testing::Test
     boost::asio::io_context m_context;
 };
 
+TEST_F(ConnectionTest, sslContext_shared)
+{
+    ConnectionOptions options;
+    options.sslContext = std::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tlsv13_client);
+    {
+        internals::Connection first(getIoContext(), options);
+        internals::Connection second(getIoContext(), options);
+        EXPECT_EQ(options.sslContext.use_count(), 3);
+    }
+    EXPECT_EQ(options.sslContext.use_count(), 1);
+}
+
+TEST_F(ConnectionTest, getRttHistogram_per_connection)
+{
+    internals::Connection first(getIoContext());
+    internals::Connection second(getIoContext());
+
+    ASSERT_NE(first.getRttHistogram(), nullptr);
+    EXPECT_NE(first.getRttHistogram(), second.getRttHistogram());
+    EXPECT_EQ(first.getRttHistogram()->count(), 0);
+}
+
 TEST_F(ConnectionTest, connect_exception)
 {
     internals::Connection connection(getIoContext());
     EXPECT_THROW(runAwaitableVoid(connection.connect(boost::url("wss://localhost:99999"))), exception::ConnectionClosed);
 }
 
+TEST_F(ConnectionTest, tryConnect_error)
+{
+    internals::Connection connection(getIoContext());
+
+    Result<void> result;
+    EXPECT_NO_THROW(result = runAwaitable(connection.tryConnect(boost::url("wss://localhost:99999"))));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Errc::ConnectionClosed);
+    EXPECT_FALSE(result.error().message().empty());
+}
+
 TEST_F(ConnectionTest, disconnect_exception)
 {
     internals::Connection connection(getIoContext());
@@ -103,6 +139,108 @@ TEST_F(ConnectionTest, makeRequest_exception)
     EXPECT_THROW(runAwaitableVoid(connection.makeRequest(command)), exception::ConnectionClosed);
 }
 
+TEST_F(ConnectionTest, sendMessage_concurrent_exception)
+{
+    internals::Connection connection(getIoContext());
+
+    // Both messages are queued and written in turn, each caller gets its own error
+    int failedMessages = 0;
+    for (const std::string_view message : {R"({"command":"ping"})", R"({"command":"getVersion"})"})
+    {
+        boost::asio::co_spawn(
+            getIoContext(),
+            [&connection, &failedMessages, message]() -> boost::asio::awaitable<void> {
+                try
+                {
+                    co_await connection.sendMessage(message);
+                }
+                catch (const exception::ConnectionClosed &)
+                {
+                    ++failedMessages;
+                }
+            },
+            boost::asio::detached);
+    }
+    getIoContext().run();
+
+    EXPECT_EQ(failedMessages, 2);
+}
+
+TEST_F(ConnectionTest, sendMessage_failure_fails_queue)
+{
+    // Holds the first write back until every message is queued, and counts the tokens taken
+    class CountingRateLimiter final : public IRateLimiter
+    {
+      public:
+        boost::asio::awaitable<void> acquire() override
+        {
+            ++acquired;
+            boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, std::chrono::milliseconds(10));
+            co_await timer.async_wait(boost::asio::use_awaitable);
+        }
+
+        int acquired = 0;
+    };
+
+    ConnectionOptions options;
+    auto rateLimiter = std::make_shared<CountingRateLimiter>();
+    options.rateLimiter = rateLimiter;
+    internals::Connection connection(getIoContext(), options);
+
+    int failedMessages = 0;
+    for (const std::string_view message : {R"({"command":"ping"})", R"({"command":"getVersion"})",
+                                           R"({"command":"getServerTime"})"})
+    {
+        boost::asio::co_spawn(
+            getIoContext(),
+            [&connection, &failedMessages, message]() -> boost::asio::awaitable<void> {
+                if (!co_await connection.trySendMessage(message))
+                {
+                    ++failedMessages;
+                }
+            },
+            boost::asio::detached);
+    }
+    getIoContext().run();
+
+    // The first failed write fails the whole queue, without taking a token for every message
+    EXPECT_EQ(failedMessages, 3);
+    EXPECT_EQ(rateLimiter->acquired, 1);
+}
+
+TEST_F(ConnectionTest, trySendMessage_canceled_while_queued)
+{
+    // Holds the writer back past the deadline
+    class StalledRateLimiter final : public IRateLimiter
+    {
+      public:
+        boost::asio::awaitable<void> acquire() override
+        {
+            boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, std::chrono::milliseconds(200));
+            boost::system::error_code ignored;
+            co_await timer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
+        }
+    };
+
+    ConnectionOptions options;
+    options.rateLimiter = std::make_shared<StalledRateLimiter>();
+    internals::Connection connection(getIoContext(), options);
+
+    Result<void> result;
+    std::chrono::steady_clock::duration elapsed{};
+    EXPECT_NO_THROW(runAwaitableVoid([&]() -> boost::asio::awaitable<void> {
+        const auto start = std::chrono::steady_clock::now();
+        result = co_await withDeadline(connection.trySendMessage(R"({"command":"ping"})"),
+                                       std::chrono::milliseconds(10));
+        elapsed = std::chrono::steady_clock::now() - start;
+    }()));
+
+    // The queued message is dropped at the deadline instead of waiting for its token
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Errc::RequestTimeout);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(150));
+}
+
 TEST_F(ConnectionTest, waitResponse_exception)
 {
     internals::Connection connection(getIoContext());
@@ -111,3 +249,13 @@ TEST_F(ConnectionTest, waitResponse_exception)
     EXPECT_THROW(result = runAwaitable(connection.waitResponse()), exception::ConnectionClosed);
     EXPECT_TRUE(result.empty());
 }
+
+TEST_F(ConnectionTest, tryWaitResponse_error)
+{
+    internals::Connection connection(getIoContext());
+
+    Result<boost::json::object> result;
+    EXPECT_NO_THROW(result = runAwaitable(connection.tryWaitResponse()));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Errc::ConnectionClosed);
+}
@@ -0,0 +1,26 @@
+#include "xapi/Endpoint.hpp"
+#include <gtest/gtest.h>
+
+using namespace xapi;
+
+TEST(EndpointTest, url_default)
+{
+    Endpoint endpoint;
+
+    EXPECT_EQ(endpoint.url("demo").buffer(), "wss://ws.xtb.com/demo");
+    EXPECT_EQ(endpoint.url("realStream").buffer(), "wss://ws.xtb.com/realStream");
+}
+
+TEST(EndpointTest, url_plain_with_port_and_prefix)
+{
+    Endpoint endpoint;
+    endpoint.tls = false;
+    endpoint.host = "127.0.0.1";
+    endpoint.port = 8080;
+    endpoint.pathPrefix = "/xapi/";
+
+    const boost::url url = endpoint.url("demo");
+    EXPECT_EQ(url.buffer(), "ws://127.0.0.1:8080/xapi/demo");
+    EXPECT_EQ(url.scheme_id(), boost::urls::scheme::ws);
+    EXPECT_EQ(url.port_number(), 8080);
+}
@@ -0,0 +1,127 @@
+#include "xapi/EndpointRace.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <optional>
+
+using namespace xapi;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+boost::asio::ip::tcp::endpoint makeEndpoint(const char *address, unsigned short port)
+{
+    return {boost::asio::ip::make_address(address), port};
+}
+
+// Port on loopback with nobody listening, connections to it are refused
+boost::asio::ip::tcp::endpoint refusedEndpoint(boost::asio::io_context &ioContext)
+{
+    boost::asio::ip::tcp::acceptor acceptor(ioContext, {boost::asio::ip::address_v4::loopback(), 0});
+    return acceptor.local_endpoint();
+}
+
+} // namespace
+
+TEST(EndpointRaceTest, interleaveAddressFamilies_alternates)
+{
+    const std::vector<boost::asio::ip::tcp::endpoint> endpoints = {
+        makeEndpoint("::1", 1), makeEndpoint("::2", 1), makeEndpoint("10.0.0.1", 1), makeEndpoint("10.0.0.2", 1),
+        makeEndpoint("10.0.0.3", 1)};
+    const std::vector<boost::asio::ip::tcp::endpoint> expected = {
+        makeEndpoint("::1", 1), makeEndpoint("10.0.0.1", 1), makeEndpoint("::2", 1), makeEndpoint("10.0.0.2", 1),
+        makeEndpoint("10.0.0.3", 1)};
+
+    EXPECT_EQ(internals::interleaveAddressFamilies(endpoints), expected);
+    EXPECT_TRUE(internals::interleaveAddressFamilies({}).empty());
+}
+
+TEST(EndpointRaceTest, raceConnect_skips_refused_endpoint)
+{
+    boost::asio::io_context ioContext;
+    boost::asio::ip::tcp::acceptor acceptor(ioContext, {boost::asio::ip::address_v4::loopback(), 0});
+    const std::vector<boost::asio::ip::tcp::endpoint> endpoints = {refusedEndpoint(ioContext),
+                                                                   acceptor.local_endpoint()};
+
+    std::optional<boost::asio::ip::tcp::socket> socket;
+    const auto start = std::chrono::steady_clock::now();
+    boost::asio::co_spawn(
+        ioContext,
+        [&]() -> boost::asio::awaitable<void> {
+            socket.emplace(co_await internals::raceConnect(ioContext.get_executor(), endpoints, 5s));
+        },
+        boost::asio::detached);
+    ioContext.run();
+
+    ASSERT_TRUE(socket.has_value());
+    EXPECT_EQ(socket->remote_endpoint(), acceptor.local_endpoint());
+    // The refused attempt starts the next one right away, without waiting for the delay
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+}
+
+TEST(EndpointRaceTest, raceConnect_does_not_wait_for_stalled_endpoint)
+{
+    boost::asio::io_context ioContext;
+    boost::asio::ip::tcp::acceptor acceptor(ioContext, {boost::asio::ip::address_v4::loopback(), 0});
+
+    // Listener with a full backlog, further connection attempts to it stall
+    boost::asio::ip::tcp::acceptor stalledAcceptor(ioContext);
+    stalledAcceptor.open(boost::asio::ip::tcp::v4());
+    stalledAcceptor.bind({boost::asio::ip::address_v4::loopback(), 0});
+    stalledAcceptor.listen(0);
+    boost::asio::ip::tcp::socket backlogFiller(ioContext);
+    backlogFiller.connect(stalledAcceptor.local_endpoint());
+
+    const std::vector<boost::asio::ip::tcp::endpoint> endpoints = {stalledAcceptor.local_endpoint(),
+                                                                   acceptor.local_endpoint()};
+
+    std::optional<boost::asio::ip::tcp::socket> socket;
+    const auto start = std::chrono::steady_clock::now();
+    boost::asio::co_spawn(
+        ioContext,
+        [&]() -> boost::asio::awaitable<void> {
+            socket.emplace(co_await internals::raceConnect(ioContext.get_executor(), endpoints, 50ms));
+        },
+        boost::asio::detached);
+    ioContext.run();
+
+    ASSERT_TRUE(socket.has_value());
+    EXPECT_EQ(socket->remote_endpoint(), acceptor.local_endpoint());
+    // The stalled attempt costs one delay and is canceled once the second one wins
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 50ms);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+}
+
+TEST(EndpointRaceTest, raceConnect_all_refused)
+{
+    boost::asio::io_context ioContext;
+    const std::vector<boost::asio::ip::tcp::endpoint> endpoints = {refusedEndpoint(ioContext),
+                                                                   refusedEndpoint(ioContext)};
+
+    std::exception_ptr error;
+    boost::asio::co_spawn(
+        ioContext,
+        [&]() -> boost::asio::awaitable<void> {
+            co_await internals::raceConnect(ioContext.get_executor(), endpoints, 50ms);
+        },
+        [&error](std::exception_ptr eptr) { error = eptr; });
+    ioContext.run();
+
+    ASSERT_TRUE(error);
+    EXPECT_THROW(std::rethrow_exception(error), boost::system::system_error);
+}
+
+TEST(EndpointRaceTest, raceConnect_no_endpoints)
+{
+    boost::asio::io_context ioContext;
+
+    std::exception_ptr error;
+    boost::asio::co_spawn(
+        ioContext,
+        [&]() -> boost::asio::awaitable<void> { co_await internals::raceConnect(ioContext.get_executor(), {}, 50ms); },
+        [&error](std::exception_ptr eptr) { error = eptr; });
+    ioContext.run();
+
+    ASSERT_TRUE(error);
+    EXPECT_THROW(std::rethrow_exception(error), boost::system::system_error);
+}
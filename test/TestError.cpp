@@ -0,0 +1,103 @@
+#include "xapi/Error.hpp"
+#include "xapi/Exceptions.hpp"
+#include <boost/asio/error.hpp>
+#include <boost/system/system_error.hpp>
+#include <gtest/gtest.h>
+#include <string>
+
+namespace xapi
+{
+
+TEST(ErrorTest, error_code_of_errc)
+{
+    const boost::system::error_code code = Errc::RequestTimeout;
+
+    EXPECT_EQ(&code.category(), &errorCategory());
+    EXPECT_STREQ(code.category().name(), "xapi");
+    EXPECT_EQ(code.message(), "Request timed out");
+    EXPECT_EQ(code, Errc::RequestTimeout);
+    EXPECT_NE(code, Errc::ConnectionClosed);
+}
+
+TEST(ErrorTest, message_falls_back_to_code)
+{
+    Error error = Error::make(Errc::ConnectionClosed, "", boost::asio::error::eof);
+    EXPECT_EQ(error.message(), "Connection closed");
+    EXPECT_EQ(error.cause, boost::asio::error::eof);
+
+    error.description = "Connection closed by remote host";
+    EXPECT_EQ(error.message(), "Connection closed by remote host");
+}
+
+TEST(ResultTest, value)
+{
+    Result<std::string> result(std::string("value"));
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(static_cast<bool>(result));
+    EXPECT_EQ(*result, "value");
+    EXPECT_EQ(result->size(), 5u);
+    EXPECT_EQ(std::move(result).value(), "value");
+}
+
+TEST(ResultTest, const_access)
+{
+    const Result<std::string> result(std::string("value"));
+
+    EXPECT_EQ(*result, "value");
+    EXPECT_EQ(result->size(), 5u);
+    EXPECT_EQ(result.value(), "value");
+}
+
+TEST(ResultTest, value_of_error_throws)
+{
+    Result<std::string> result(Error::make(Errc::RequestTimeout, "timeout"));
+    const Result<std::string> &constResult = result;
+    const Result<void> failure(Error::make(Errc::ConnectionClosed, "closed"));
+
+    EXPECT_THROW(result.value(), exception::RequestTimeout);
+    EXPECT_THROW(constResult.value(), exception::RequestTimeout);
+    EXPECT_THROW(std::move(result).value(), exception::RequestTimeout);
+    EXPECT_THROW(failure.value(), exception::ConnectionClosed);
+    EXPECT_NO_THROW(Result<void>().value());
+}
+
+TEST(ResultTest, error)
+{
+    Error rejected = Error::make(Errc::RequestRejected, "Symbol does not exist");
+    rejected.serverCode = "BE005";
+    const Result<std::string> result(rejected);
+
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Errc::RequestRejected);
+    EXPECT_EQ(result.error().serverCode, "BE005");
+    EXPECT_EQ(result.error().message(), "Symbol does not exist");
+}
+
+TEST(ResultTest, void_result)
+{
+    const Result<void> success;
+    const Result<void> failure(Error::make(Errc::LoginFailed, "Invalid account type: test"));
+
+    EXPECT_TRUE(success.has_value());
+    ASSERT_FALSE(failure.has_value());
+    EXPECT_EQ(failure.error().code, Errc::LoginFailed);
+}
+
+TEST(ResultTest, unwrap_throws_matching_exception)
+{
+    EXPECT_EQ(internals::unwrap(Result<int>(42)), 42);
+    EXPECT_NO_THROW(internals::unwrap(Result<void>()));
+
+    EXPECT_THROW(internals::unwrap(Result<int>(Error::make(Errc::ConnectionClosed, "closed"))),
+                 exception::ConnectionClosed);
+    EXPECT_THROW(internals::unwrap(Result<int>(Error::make(Errc::RequestTimeout, "timeout"))),
+                 exception::RequestTimeout);
+    EXPECT_THROW(internals::unwrap(Result<void>(Error::make(Errc::LoginFailed, "login"))), exception::LoginFailed);
+
+    Error canceled;
+    canceled.code = boost::asio::error::operation_aborted;
+    EXPECT_THROW(internals::unwrap(Result<int>(canceled)), boost::system::system_error);
+}
+
+} // namespace xapi
@@ -0,0 +1,184 @@
+#include "MockConnection.hpp"
+#include "xapi/Exceptions.hpp"
+#include "xapi/HedgedClient.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+
+namespace xapi
+{
+
+class HedgedClientTest : public ::testing::Test
+{
+  protected:
+    std::unique_ptr<XStationClient> primary;
+    std::unique_ptr<XStationClient> secondary;
+
+    void SetUp() override
+    {
+        primary = std::make_unique<XStationClient>(m_context, "test", "test", "demo");
+        primary->m_connection = std::make_unique<MockConnection>();
+        secondary = std::make_unique<XStationClient>(m_context, "test", "test", "demo");
+        secondary->m_connection = std::make_unique<MockConnection>();
+    }
+
+    void TearDown() override
+    {
+        primary.reset();
+        secondary.reset();
+    }
+
+    MockConnection &getMockedConnection(XStationClient &client)
+    {
+        return *dynamic_cast<MockConnection *>(client.m_connection.get());
+    }
+
+    // Expects one request on the session, answered after the delay.
+    void expectRequest(XStationClient &client, std::chrono::milliseconds delay, const std::string &returnData)
+    {
+        EXPECT_CALL(getMockedConnection(client), makeRequest(testing::_))
+            .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+        EXPECT_CALL(getMockedConnection(client), waitResponse())
+            .WillOnce([delay, returnData]() -> boost::asio::awaitable<boost::json::object> {
+                boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, delay);
+                co_await timer.async_wait(boost::asio::use_awaitable);
+                co_return boost::json::object{{"status", true}, {"returnData", returnData}, {"customTag", "1"}};
+            });
+    }
+
+    boost::json::object runRequest(HedgedClient &hedgedClient)
+    {
+        std::exception_ptr eptr;
+        boost::json::object result;
+        boost::asio::co_spawn(
+            m_context,
+            [&]() -> boost::asio::awaitable<void> {
+                try
+                {
+                    result = co_await hedgedClient.getServerTime();
+                }
+                catch (...)
+                {
+                    eptr = std::current_exception();
+                }
+            },
+            boost::asio::detached);
+
+        m_context.run();
+        m_context.restart();
+
+        if (eptr)
+        {
+            std::rethrow_exception(eptr);
+        }
+        return result;
+    }
+
+  private:
+    boost::asio::io_context m_context;
+};
+
+TEST_F(HedgedClientTest, fast_primary_not_hedged)
+{
+    expectRequest(*primary, std::chrono::milliseconds(0), "primary");
+
+    HedgingOptions options;
+    options.initialThreshold = std::chrono::seconds(5);
+    HedgedClient hedgedClient(*primary, *secondary, options);
+
+    const auto result = runRequest(hedgedClient);
+    EXPECT_EQ(result.at("returnData").as_string(), "primary");
+
+    const HedgingStats stats = hedgedClient.getStats();
+    EXPECT_EQ(stats.requests, 1u);
+    EXPECT_EQ(stats.hedged, 0u);
+    EXPECT_EQ(stats.hedgeRate(), 0.0);
+    EXPECT_EQ(hedgedClient.getLatencyHistogram()->count(), 1u);
+}
+
+TEST_F(HedgedClientTest, slow_primary_hedged)
+{
+    expectRequest(*primary, std::chrono::milliseconds(200), "primary");
+    expectRequest(*secondary, std::chrono::milliseconds(0), "secondary");
+
+    HedgingOptions options;
+    options.initialThreshold = std::chrono::milliseconds(10);
+    HedgedClient hedgedClient(*primary, *secondary, options);
+
+    const auto result = runRequest(hedgedClient);
+    EXPECT_EQ(result.at("returnData").as_string(), "secondary");
+
+    // The late response of the primary session is recorded once it arrives
+    const HedgingStats stats = hedgedClient.getStats();
+    EXPECT_EQ(stats.requests, 1u);
+    EXPECT_EQ(stats.hedged, 1u);
+    EXPECT_EQ(stats.hedgeWins, 1u);
+    EXPECT_EQ(stats.hedgeRate(), 1.0);
+    EXPECT_GE(stats.latencySaved, std::chrono::milliseconds(150));
+    EXPECT_EQ(hedgedClient.getLatencyHistogram()->count(), 1u);
+}
+
+TEST_F(HedgedClientTest, failed_primary_hedged_at_once)
+{
+    EXPECT_CALL(getMockedConnection(*primary), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+    EXPECT_CALL(getMockedConnection(*primary), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            throw exception::ConnectionClosed("Exception");
+        });
+    expectRequest(*secondary, std::chrono::milliseconds(0), "secondary");
+
+    HedgingOptions options;
+    options.initialThreshold = std::chrono::seconds(5);
+    HedgedClient hedgedClient(*primary, *secondary, options);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = runRequest(hedgedClient);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    EXPECT_EQ(result.at("returnData").as_string(), "secondary");
+    EXPECT_EQ(hedgedClient.getStats().hedged, 1u);
+}
+
+TEST_F(HedgedClientTest, both_sessions_failed)
+{
+    for (XStationClient *client : {primary.get(), secondary.get()})
+    {
+        EXPECT_CALL(getMockedConnection(*client), makeRequest(testing::_))
+            .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+        EXPECT_CALL(getMockedConnection(*client), waitResponse())
+            .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+                throw exception::ConnectionClosed("Exception");
+            });
+    }
+
+    HedgedClient hedgedClient(*primary, *secondary);
+    EXPECT_THROW(runRequest(hedgedClient), exception::ConnectionClosed);
+}
+
+TEST_F(HedgedClientTest, threshold_from_percentile)
+{
+    EXPECT_CALL(getMockedConnection(*primary), makeRequest(testing::_))
+        .Times(2)
+        .WillRepeatedly([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+    EXPECT_CALL(getMockedConnection(*primary), waitResponse())
+        .Times(2)
+        .WillRepeatedly([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", true}};
+        });
+
+    HedgingOptions options;
+    options.minSamples = 2;
+    options.initialThreshold = std::chrono::seconds(5);
+    options.minThreshold = std::chrono::milliseconds(20);
+    HedgedClient hedgedClient(*primary, *secondary, options);
+    EXPECT_EQ(hedgedClient.hedgeThreshold(), std::chrono::seconds(5));
+
+    runRequest(hedgedClient);
+    runRequest(hedgedClient);
+
+    // Answered at once, so the percentile is below the lower bound
+    EXPECT_EQ(hedgedClient.hedgeThreshold(), std::chrono::milliseconds(20));
+}
+
+} // namespace xapi
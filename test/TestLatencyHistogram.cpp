@@ -0,0 +1,101 @@
+#include "xapi/LatencyHistogram.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using namespace xapi;
+using namespace std::chrono_literals;
+
+TEST(LatencyHistogramTest, empty)
+{
+    LatencyHistogram histogram;
+
+    EXPECT_EQ(histogram.count(), 0);
+    EXPECT_EQ(histogram.min(), 0us);
+    EXPECT_EQ(histogram.max(), 0us);
+    EXPECT_EQ(histogram.mean(), 0us);
+    EXPECT_EQ(histogram.percentile(99.0), 0us);
+}
+
+TEST(LatencyHistogramTest, small_values_exact)
+{
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 100; ++i)
+    {
+        histogram.record(std::chrono::microseconds(i));
+    }
+
+    EXPECT_EQ(histogram.count(), 100);
+    EXPECT_EQ(histogram.min(), 1us);
+    EXPECT_EQ(histogram.max(), 100us);
+    EXPECT_EQ(histogram.mean(), 50us);
+    EXPECT_EQ(histogram.percentile(50.0), 50us);
+    EXPECT_EQ(histogram.percentile(99.0), 99us);
+    EXPECT_EQ(histogram.percentile(100.0), 100us);
+}
+
+TEST(LatencyHistogramTest, large_values_within_relative_error)
+{
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 1000; ++i)
+    {
+        histogram.record(std::chrono::microseconds(i * 997));
+    }
+
+    for (double percentile : {10.0, 50.0, 90.0, 99.0, 99.9})
+    {
+        const double expected = std::ceil(percentile * 10.0) * 997.0;
+        const double actual = static_cast<double>(histogram.percentile(percentile).count());
+        EXPECT_GE(actual, expected) << percentile;
+        EXPECT_LE(actual, expected * 1.016) << percentile;
+    }
+    EXPECT_EQ(histogram.max(), 997000us);
+}
+
+TEST(LatencyHistogramTest, out_of_range_values_clamped)
+{
+    LatencyHistogram histogram;
+    histogram.record(-5us);
+    histogram.record(std::chrono::hours(100));
+
+    EXPECT_EQ(histogram.count(), 2);
+    EXPECT_EQ(histogram.min(), 0us);
+    EXPECT_EQ(histogram.percentile(0.0), 0us);
+    EXPECT_EQ(histogram.percentile(100.0), histogram.max());
+}
+
+TEST(LatencyHistogramTest, reset)
+{
+    LatencyHistogram histogram;
+    histogram.record(10us);
+    histogram.reset();
+
+    EXPECT_EQ(histogram.count(), 0);
+    histogram.record(20us);
+    EXPECT_EQ(histogram.min(), 20us);
+    EXPECT_EQ(histogram.percentile(50.0), 20us);
+}
+
+TEST(LatencyHistogramTest, concurrent_record)
+{
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&histogram]() {
+            for (int i = 0; i < 10000; ++i)
+            {
+                histogram.record(std::chrono::microseconds(i));
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(histogram.count(), 40000);
+    EXPECT_EQ(histogram.max(), 9999us);
+}
@@ -0,0 +1,63 @@
+#include "xapi/RateLimiter.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+
+using namespace xapi;
+using namespace std::chrono_literals;
+
+TEST(RateLimiterTest, reserve_burst_is_immediate)
+{
+    RateLimiter rateLimiter(100ms, 3);
+
+    const auto now = RateLimiter::Clock::now();
+    EXPECT_LE(rateLimiter.reserve(), now + 10ms);
+    EXPECT_LE(rateLimiter.reserve(), now + 10ms);
+    EXPECT_LE(rateLimiter.reserve(), now + 10ms);
+    EXPECT_GE(rateLimiter.reserve(), now + 100ms);
+}
+
+TEST(RateLimiterTest, reserve_spaces_requests_after_burst)
+{
+    RateLimiter rateLimiter(100ms, 1);
+
+    const auto first = rateLimiter.reserve();
+    const auto second = rateLimiter.reserve();
+    const auto third = rateLimiter.reserve();
+    EXPECT_EQ(second - first, 100ms);
+    EXPECT_EQ(third - second, 100ms);
+}
+
+TEST(RateLimiterTest, tryAcquire_takes_available_tokens_only)
+{
+    RateLimiter rateLimiter(100ms, 2);
+
+    EXPECT_TRUE(rateLimiter.tryAcquire());
+    EXPECT_TRUE(rateLimiter.tryAcquire());
+    EXPECT_FALSE(rateLimiter.tryAcquire());
+
+    // A failed attempt does not reserve a token
+    EXPECT_LE(rateLimiter.reserve(), RateLimiter::Clock::now() + 100ms);
+}
+
+TEST(RateLimiterTest, acquire_waits_for_token)
+{
+    boost::asio::io_context ioContext;
+    auto rateLimiter = std::make_shared<RateLimiter>(50ms, 1);
+
+    const auto start = RateLimiter::Clock::now();
+    int acquired = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        boost::asio::co_spawn(
+            ioContext,
+            [rateLimiter, &acquired]() -> boost::asio::awaitable<void> {
+                co_await rateLimiter->acquire();
+                ++acquired;
+            },
+            boost::asio::detached);
+    }
+    ioContext.run();
+
+    EXPECT_EQ(acquired, 3);
+    EXPECT_GE(RateLimiter::Clock::now() - start, 100ms);
+}
@@ -0,0 +1,55 @@
+#include "xapi/ReconnectPolicy.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+
+using namespace xapi;
+using namespace std::chrono_literals;
+
+TEST(BackoffTest, nextDelay_grows_up_to_max)
+{
+    ReconnectPolicy policy;
+    policy.initialDelay = 100ms;
+    policy.maxDelay = 500ms;
+    policy.multiplier = 2.0;
+    policy.jitter = 0.0;
+    Backoff backoff(policy);
+
+    EXPECT_EQ(backoff.nextDelay(), 100ms);
+    EXPECT_EQ(backoff.nextDelay(), 200ms);
+    EXPECT_EQ(backoff.nextDelay(), 400ms);
+    EXPECT_EQ(backoff.nextDelay(), 500ms);
+    EXPECT_EQ(backoff.nextDelay(), 500ms);
+}
+
+TEST(BackoffTest, nextDelay_jitter_within_bounds)
+{
+    ReconnectPolicy policy;
+    policy.initialDelay = 1000ms;
+    policy.maxDelay = 1000ms;
+    policy.jitter = 0.5;
+    Backoff backoff(policy);
+
+    bool varies = false;
+    const auto first = backoff.nextDelay();
+    for (int i = 0; i < 100; ++i)
+    {
+        const auto delay = backoff.nextDelay();
+        EXPECT_GE(delay, 500ms);
+        EXPECT_LE(delay, 1000ms);
+        varies = varies || delay != first;
+    }
+    EXPECT_TRUE(varies);
+}
+
+TEST(BackoffTest, reset_restarts_from_initial_delay)
+{
+    ReconnectPolicy policy;
+    policy.initialDelay = 100ms;
+    policy.jitter = 0.0;
+    Backoff backoff(policy);
+
+    backoff.nextDelay();
+    backoff.nextDelay();
+    backoff.reset();
+    EXPECT_EQ(backoff.nextDelay(), 100ms);
+}
@@ -0,0 +1,57 @@
+#include "xapi/ResolverCache.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+
+using namespace xapi;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+ResolverCache::Endpoints resolve(ResolverCache &resolverCache, std::string_view host, std::string_view port)
+{
+    boost::asio::io_context ioContext;
+    ResolverCache::Endpoints endpoints;
+    boost::asio::co_spawn(
+        ioContext,
+        [&]() -> boost::asio::awaitable<void> { endpoints = co_await resolverCache.resolve(host, port); },
+        boost::asio::detached);
+    ioContext.run();
+    return endpoints;
+}
+
+} // namespace
+
+TEST(ResolverCacheTest, resolve_caches_result)
+{
+    ResolverCache resolverCache(1min);
+
+    const auto endpoints = resolve(resolverCache, "127.0.0.1", "443");
+    ASSERT_EQ(endpoints.size(), 1);
+    EXPECT_EQ(endpoints.front(), boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 443));
+    EXPECT_EQ(resolverCache.size(), 1);
+
+    EXPECT_EQ(resolve(resolverCache, "127.0.0.1", "443"), endpoints);
+    EXPECT_EQ(resolverCache.size(), 1);
+
+    resolve(resolverCache, "127.0.0.1", "80");
+    EXPECT_EQ(resolverCache.size(), 2);
+}
+
+TEST(ResolverCacheTest, invalidate_drops_result)
+{
+    ResolverCache resolverCache(1min);
+    resolve(resolverCache, "127.0.0.1", "443");
+
+    resolverCache.invalidate("127.0.0.1", "443");
+    EXPECT_EQ(resolverCache.size(), 0);
+}
+
+TEST(ResolverCacheTest, resolve_replaces_expired_result)
+{
+    ResolverCache resolverCache(0s);
+    resolve(resolverCache, "127.0.0.1", "443");
+
+    EXPECT_EQ(resolve(resolverCache, "127.0.0.1", "443").size(), 1);
+    EXPECT_EQ(resolverCache.size(), 1);
+}
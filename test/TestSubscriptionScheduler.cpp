@@ -0,0 +1,182 @@
+#include "MockConnection.hpp"
+#include "xapi/Exceptions.hpp"
+#include "xapi/SubscriptionScheduler.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace xapi
+{
+
+class SubscriptionSchedulerTest : public ::testing::Test
+{
+  protected:
+    std::vector<std::unique_ptr<XStationClientStream>> streams;
+
+    void SetUp() override
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            streams.push_back(std::make_unique<XStationClientStream>(m_context, "demo", "testStreamSessionId"));
+            streams.back()->m_connection = std::make_unique<MockConnection>();
+        }
+    }
+
+    void TearDown() override
+    {
+        streams.clear();
+    }
+
+    MockConnection &getMockedConnection(std::size_t index)
+    {
+        return *dynamic_cast<MockConnection *>(streams[index]->m_connection.get());
+    }
+
+    // Records the symbols subscribed on the stream, each taking the given time to send.
+    void expectSubscriptions(std::size_t index, std::vector<std::string> &symbols, std::chrono::milliseconds delay)
+    {
+        EXPECT_CALL(getMockedConnection(index), makeRequest(testing::_))
+            .WillRepeatedly([&symbols, delay](const boost::json::object &command) -> boost::asio::awaitable<void> {
+                boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, delay);
+                co_await timer.async_wait(boost::asio::use_awaitable);
+                symbols.push_back(std::string(command.at("symbol").as_string()));
+            });
+    }
+
+    void expectFailure(std::size_t index)
+    {
+        EXPECT_CALL(getMockedConnection(index), makeRequest(testing::_))
+            .WillOnce([](const boost::json::object &) -> boost::asio::awaitable<void> {
+                throw exception::ConnectionClosed("Exception");
+            });
+    }
+
+    SubscriptionProgress scheduleAndWait(SubscriptionScheduler &scheduler, std::vector<Subscription> subscriptions)
+    {
+        SubscriptionProgress progress;
+        boost::asio::co_spawn(
+            m_context,
+            [&]() -> boost::asio::awaitable<void> {
+                co_await scheduler.schedule(std::move(subscriptions));
+                progress = co_await scheduler.waitLive();
+            },
+            boost::asio::detached);
+        m_context.run();
+        return progress;
+    }
+
+    static std::vector<Subscription> makeUniverse(std::size_t size)
+    {
+        std::vector<Subscription> universe;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            Subscription subscription;
+            subscription.symbol = "SYM" + std::to_string(i);
+            universe.push_back(subscription);
+        }
+        return universe;
+    }
+
+  private:
+    boost::asio::io_context m_context;
+};
+
+TEST(SubscriptionSchedulerConstructorTest, no_streams)
+{
+    std::vector<std::reference_wrapper<XStationClientStream>> streams;
+    EXPECT_THROW(SubscriptionScheduler scheduler(streams), std::invalid_argument);
+}
+
+TEST_F(SubscriptionSchedulerTest, hot_symbols_first)
+{
+    std::vector<std::string> symbols;
+    expectSubscriptions(0, symbols, std::chrono::milliseconds(0));
+
+    std::vector<Subscription> universe(4);
+    universe[0].symbol = "COLD";
+    universe[1].symbol = "HOT";
+    universe[1].priority = 10;
+    universe[2].symbol = "WARM";
+    universe[2].priority = 5;
+    universe[3].symbol = "CANDLES";
+    universe[3].type = SubscriptionType::Candles;
+    universe[3].priority = 5;
+
+    SubscriptionScheduler scheduler({*streams[0]});
+    const SubscriptionProgress progress = scheduleAndWait(scheduler, universe);
+
+    const std::vector<std::string> expectedSymbols = {"HOT", "WARM", "CANDLES", "COLD"};
+    EXPECT_EQ(symbols, expectedSymbols);
+    EXPECT_EQ(progress.total, 4u);
+    EXPECT_EQ(progress.live, 4u);
+    EXPECT_EQ(progress.pending(), 0u);
+}
+
+TEST_F(SubscriptionSchedulerTest, work_balanced_across_streams)
+{
+    std::vector<std::string> firstSymbols;
+    std::vector<std::string> secondSymbols;
+    expectSubscriptions(0, firstSymbols, std::chrono::milliseconds(10));
+    expectSubscriptions(1, secondSymbols, std::chrono::milliseconds(10));
+
+    SubscriptionScheduler scheduler({*streams[0], *streams[1]});
+    const SubscriptionProgress progress = scheduleAndWait(scheduler, makeUniverse(6));
+
+    EXPECT_EQ(firstSymbols.size(), 3u);
+    EXPECT_EQ(secondSymbols.size(), 3u);
+    EXPECT_EQ(progress.live, 6u);
+}
+
+TEST_F(SubscriptionSchedulerTest, failed_stream_taken_over)
+{
+    std::vector<std::string> symbols;
+    expectFailure(0);
+    expectSubscriptions(1, symbols, std::chrono::milliseconds(1));
+
+    SubscriptionScheduler scheduler({*streams[0], *streams[1]});
+    const SubscriptionProgress progress = scheduleAndWait(scheduler, makeUniverse(4));
+
+    EXPECT_EQ(symbols.size(), 4u);
+    EXPECT_EQ(progress.live, 4u);
+    EXPECT_EQ(progress.failed, 0u);
+}
+
+TEST_F(SubscriptionSchedulerTest, all_streams_failed)
+{
+    expectFailure(0);
+    expectFailure(1);
+
+    SubscriptionScheduler scheduler({*streams[0], *streams[1]});
+    const SubscriptionProgress progress = scheduleAndWait(scheduler, makeUniverse(5));
+
+    EXPECT_EQ(progress.total, 5u);
+    EXPECT_EQ(progress.live, 0u);
+    EXPECT_EQ(progress.failed, 5u);
+}
+
+TEST_F(SubscriptionSchedulerTest, other_error_counted_as_failed)
+{
+    // The first subscription fails with an error other than a closed connection, the stream goes on
+    std::vector<std::string> symbols;
+    EXPECT_CALL(getMockedConnection(0), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &) -> boost::asio::awaitable<void> {
+            throw std::runtime_error("Exception");
+        })
+        .WillRepeatedly([&symbols](const boost::json::object &command) -> boost::asio::awaitable<void> {
+            symbols.push_back(std::string(command.at("symbol").as_string()));
+            co_return;
+        });
+
+    SubscriptionScheduler scheduler({*streams[0]});
+    const SubscriptionProgress progress = scheduleAndWait(scheduler, makeUniverse(3));
+
+    EXPECT_EQ(symbols.size(), 2u);
+    EXPECT_EQ(progress.live, 2u);
+    EXPECT_EQ(progress.failed, 1u);
+    EXPECT_EQ(progress.pending(), 0u);
+}
+
+} // namespace xapi
@@ -0,0 +1,117 @@
+#include "xapi/TlsSessionCache.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+
+using namespace xapi;
+
+class TlsSessionCacheTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        m_context.reset(SSL_CTX_new(TLS_client_method()));
+        m_ssl.reset(SSL_new(m_context.get()));
+    }
+
+  public:
+    SSL_CTX *getContext()
+    {
+        return m_context.get();
+    }
+
+    SSL *getSsl()
+    {
+        return m_ssl.get();
+    }
+
+  private:
+    struct ContextDeleter
+    {
+        void operator()(SSL_CTX *context) const
+        {
+            SSL_CTX_free(context);
+        }
+    };
+
+    struct SslDeleter
+    {
+        void operator()(SSL *ssl) const
+        {
+            SSL_free(ssl);
+        }
+    };
+
+    std::unique_ptr<SSL_CTX, ContextDeleter> m_context;
+    std::unique_ptr<SSL, SslDeleter> m_ssl;
+};
+
+TEST_F(TlsSessionCacheTest, resume_unknown_host)
+{
+    TlsSessionCache cache;
+    EXPECT_FALSE(cache.resume(getSsl(), "ws.xtb.com", "443"));
+    EXPECT_EQ(SSL_get_session(getSsl()), nullptr);
+}
+
+TEST_F(TlsSessionCacheTest, resume_stored_session)
+{
+    TlsSessionCache cache;
+    SSL_SESSION *session = SSL_SESSION_new();
+    SSL_SESSION_set_timeout(session, 1234);
+    cache.store(getContext(), "ws.xtb.com", "443", session);
+
+    EXPECT_TRUE(cache.resume(getSsl(), "ws.xtb.com", "443"));
+    // The connection gets a copy, so it cannot invalidate the cached session
+    ASSERT_NE(SSL_get_session(getSsl()), nullptr);
+    EXPECT_NE(SSL_get_session(getSsl()), session);
+    EXPECT_EQ(SSL_SESSION_get_timeout(SSL_get_session(getSsl())), 1234);
+    EXPECT_FALSE(cache.resume(getSsl(), "localhost", "443"));
+}
+
+TEST_F(TlsSessionCacheTest, store_replaces_session_of_host)
+{
+    TlsSessionCache cache;
+    cache.store(getContext(), "ws.xtb.com", "443", SSL_SESSION_new());
+    SSL_SESSION *latestSession = SSL_SESSION_new();
+    SSL_SESSION_set_timeout(latestSession, 1234);
+    cache.store(getContext(), "ws.xtb.com", "443", latestSession);
+    cache.store(getContext(), "localhost", "443", SSL_SESSION_new());
+    EXPECT_EQ(cache.size(), 2);
+
+    EXPECT_TRUE(cache.resume(getSsl(), "ws.xtb.com", "443"));
+    EXPECT_EQ(SSL_SESSION_get_timeout(SSL_get_session(getSsl())), 1234);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(TlsSessionCacheTest, resume_only_same_port_and_context)
+{
+    TlsSessionCache cache;
+    cache.store(getContext(), "ws.xtb.com", "443", SSL_SESSION_new());
+
+    EXPECT_FALSE(cache.resume(getSsl(), "ws.xtb.com", "5124"));
+    EXPECT_EQ(SSL_get_session(getSsl()), nullptr);
+
+    // E.g. a verifying context must not resume a session established without verification
+    std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> otherContext(SSL_CTX_new(TLS_client_method()), &SSL_CTX_free);
+    std::unique_ptr<SSL, decltype(&SSL_free)> otherSsl(SSL_new(otherContext.get()), &SSL_free);
+    EXPECT_FALSE(cache.resume(otherSsl.get(), "ws.xtb.com", "443"));
+    EXPECT_EQ(SSL_get_session(otherSsl.get()), nullptr);
+
+    EXPECT_TRUE(cache.resume(getSsl(), "ws.xtb.com", "443"));
+}
+
+TEST_F(TlsSessionCacheTest, attach_enables_client_session_cache)
+{
+    TlsSessionCache::attach(getContext());
+    TlsSessionCache::attach(getContext());
+
+    EXPECT_EQ(SSL_CTX_get_session_cache_mode(getContext()), SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    EXPECT_NE(SSL_CTX_sess_get_new_cb(getContext()), nullptr);
+}
+
+TEST(TlsSessionCacheSharedTest, shared_is_one_instance)
+{
+    EXPECT_NE(TlsSessionCache::shared(), nullptr);
+    EXPECT_EQ(TlsSessionCache::shared(), TlsSessionCache::shared());
+}
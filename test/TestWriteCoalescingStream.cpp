@@ -0,0 +1,128 @@
+#include "xapi/WriteCoalescingStream.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace xapi::internals;
+
+namespace
+{
+
+// Next layer recording every write it gets.
+class RecordingStream
+{
+  public:
+    using executor_type = boost::asio::any_io_executor;
+
+    explicit RecordingStream(boost::asio::io_context &ioContext) : m_executor(ioContext.get_executor())
+    {
+    }
+
+    executor_type get_executor() noexcept
+    {
+        return m_executor;
+    }
+
+    template <typename MutableBufferSequence, typename ReadToken>
+    auto async_read_some(const MutableBufferSequence &, ReadToken &&token)
+    {
+        return boost::asio::async_initiate<ReadToken, void(boost::system::error_code, std::size_t)>(
+            [this](auto handler) {
+                boost::asio::post(m_executor, boost::beast::bind_front_handler(
+                                                  std::move(handler), boost::asio::error::eof, std::size_t(0)));
+            },
+            token);
+    }
+
+    template <typename ConstBufferSequence, typename WriteToken>
+    auto async_write_some(const ConstBufferSequence &buffers, WriteToken &&token)
+    {
+        return boost::asio::async_initiate<WriteToken, void(boost::system::error_code, std::size_t)>(
+            [this](auto handler, const ConstBufferSequence &buffers) {
+                std::string data(boost::asio::buffer_size(buffers), '\0');
+                boost::asio::buffer_copy(boost::asio::buffer(data), buffers);
+                writes.push_back(data);
+                boost::asio::post(m_executor, boost::beast::bind_front_handler(
+                                                  std::move(handler), boost::system::error_code(), data.size()));
+            },
+            token, buffers);
+    }
+
+    std::vector<std::string> writes;
+
+  private:
+    executor_type m_executor;
+};
+
+void run(boost::asio::io_context &ioContext, boost::asio::awaitable<void> awaitable)
+{
+    boost::asio::co_spawn(ioContext, std::move(awaitable), [](std::exception_ptr eptr) {
+        if (eptr)
+        {
+            std::rethrow_exception(eptr);
+        }
+    });
+    ioContext.run();
+}
+
+} // namespace
+
+TEST(WriteCoalescingStreamTest, passes_writes_through_when_not_corked)
+{
+    boost::asio::io_context ioContext;
+    WriteCoalescingStream<RecordingStream> stream(ioContext);
+
+    run(ioContext, [&]() -> boost::asio::awaitable<void> {
+        co_await boost::asio::async_write(stream, boost::asio::buffer(std::string_view("first")), boost::asio::use_awaitable);
+        co_await boost::asio::async_write(stream, boost::asio::buffer(std::string_view("second")), boost::asio::use_awaitable);
+    }());
+
+    const std::vector<std::string> expectedWrites = {"first", "second"};
+    EXPECT_EQ(stream.next_layer().writes, expectedWrites);
+}
+
+TEST(WriteCoalescingStreamTest, gathers_writes_while_corked)
+{
+    boost::asio::io_context ioContext;
+    WriteCoalescingStream<RecordingStream> stream(ioContext);
+
+    run(ioContext, [&]() -> boost::asio::awaitable<void> {
+        stream.cork();
+        co_await boost::asio::async_write(stream, boost::asio::buffer(std::string_view("first")), boost::asio::use_awaitable);
+        co_await boost::asio::async_write(stream, boost::asio::buffer(std::string_view("second")), boost::asio::use_awaitable);
+        co_await boost::asio::async_write(stream, boost::asio::buffer(std::string_view("third")), boost::asio::use_awaitable);
+        EXPECT_TRUE(stream.next_layer().writes.empty());
+
+        co_await stream.flush();
+
+        // Not corked any more
+        co_await boost::asio::async_write(stream, boost::asio::buffer(std::string_view("fourth")), boost::asio::use_awaitable);
+    }());
+
+    const std::vector<std::string> expectedWrites = {"firstsecondthird", "fourth"};
+    EXPECT_EQ(stream.next_layer().writes, expectedWrites);
+}
+
+TEST(WriteCoalescingStreamTest, writes_during_flush_follow_it)
+{
+    boost::asio::io_context ioContext;
+    WriteCoalescingStream<RecordingStream> stream(ioContext);
+
+    run(ioContext, [&]() -> boost::asio::awaitable<void> {
+        stream.cork();
+        co_await boost::asio::async_write(stream, boost::asio::buffer(std::string_view("first")), boost::asio::use_awaitable);
+
+        // Starts after the flush, while it waits for the next layer
+        boost::asio::co_spawn(
+            ioContext,
+            [&]() -> boost::asio::awaitable<void> {
+                co_await boost::asio::async_write(stream, boost::asio::buffer(std::string_view("second")),
+                                                  boost::asio::use_awaitable);
+            },
+            boost::asio::detached);
+        co_await stream.flush();
+    }());
+
+    const std::vector<std::string> expectedWrites = {"first", "second"};
+    EXPECT_EQ(stream.next_layer().writes, expectedWrites);
+}
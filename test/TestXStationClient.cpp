@@ -2,8 +2,13 @@
 #include "xapi/Exceptions.hpp"
 #include "xapi/XStationClient.hpp"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <future>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace xapi
 {
@@ -175,6 +180,96 @@ TEST_F(XStationClientTest, login_ok)
     EXPECT_TRUE(client->m_streamSessionId == "test");
 }
 
+TEST_F(XStationClientTest, login_custom_endpoint)
+{
+    ConnectionOptions options;
+    options.endpoint.tls = false;
+    options.endpoint.host = "127.0.0.1";
+    options.endpoint.port = 8080;
+    client = std::make_unique<XStationClient>(getIoContext(), "test", "test", "demo", options);
+    client->m_connection = std::make_unique<MockConnection>();
+
+    EXPECT_CALL(getMockedConnection(), connect(testing::_))
+        .WillOnce([](const boost::url &url) -> boost::asio::awaitable<void> {
+            EXPECT_EQ(url.buffer(), "ws://127.0.0.1:8080/demo");
+            co_return;
+        });
+
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", true}, {"streamSessionId", "test"}};
+        });
+
+    EXPECT_NO_THROW(runAwaitableVoid(client->login()));
+    EXPECT_EQ(client->getClientStream().m_streamUrl.buffer(), "ws://127.0.0.1:8080/demoStream");
+}
+
+TEST_F(XStationClientTest, loginWithStream_ok)
+{
+    const boost::json::object serverResponse = {{"status", true}, {"streamSessionId", "test"}};
+
+    XStationClientStream stream = client->getClientStream();
+    auto streamConnection = std::make_unique<MockConnection>();
+    auto &mockedStreamConnection = *streamConnection;
+    stream.m_connection = std::move(streamConnection);
+
+    // The stream connects before the login response arrives
+    bool streamOpened = false;
+    EXPECT_CALL(mockedStreamConnection, connect(testing::_))
+        .WillOnce([&streamOpened](const boost::url &url) -> boost::asio::awaitable<void> {
+            EXPECT_EQ(url.buffer(), "wss://ws.xtb.com/demoStream");
+            streamOpened = true;
+            co_return;
+        });
+
+    EXPECT_CALL(getMockedConnection(), connect(testing::_))
+        .WillOnce([](const boost::url &url) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([&serverResponse, &streamOpened]() -> boost::asio::awaitable<boost::json::object> {
+            EXPECT_TRUE(streamOpened);
+            co_return serverResponse;
+        });
+
+    StartupReport report;
+    EXPECT_NO_THROW(report = runAwaitable(client->loginWithStream(stream)));
+    EXPECT_EQ(client->m_streamSessionId, "test");
+    EXPECT_EQ(stream.m_streamSessionId, "test");
+    EXPECT_GE(report.total, report.connect + report.login);
+    EXPECT_GE(report.total, report.streamOpen);
+}
+
+TEST_F(XStationClientTest, loginWithStream_login_failed)
+{
+    const boost::json::object serverResponse = {{"status", false}, {"errorCode", "BE005"}};
+
+    XStationClientStream stream = client->getClientStream();
+    auto streamConnection = std::make_unique<MockConnection>();
+    EXPECT_CALL(*streamConnection, connect(testing::_))
+        .WillOnce([](const boost::url &url) -> boost::asio::awaitable<void> { co_return; });
+    stream.m_connection = std::move(streamConnection);
+
+    EXPECT_CALL(getMockedConnection(), connect(testing::_))
+        .WillOnce([](const boost::url &url) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([&serverResponse]() -> boost::asio::awaitable<boost::json::object> {
+            co_return serverResponse;
+        });
+
+    EXPECT_THROW(runAwaitable(client->loginWithStream(stream)), exception::LoginFailed);
+    EXPECT_TRUE(stream.m_streamSessionId.empty());
+}
+
 TEST_F(XStationClientTest, logout_exception)
 {
     const boost::json::object expectedCommand = {{"command", "logout"}};
@@ -1377,4 +1472,378 @@ TEST_F(XStationClientTest, tradeTransactionStatus_exception)
     EXPECT_THROW(result = runAwaitable(client->tradeTransactionStatus(order)), exception::ConnectionClosed);
 }
 
+TEST_F(XStationClientTest, request_adds_customTag)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .Times(2)
+        .WillRepeatedly([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .Times(2)
+        .WillRepeatedly([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", true}};
+        });
+
+    EXPECT_NO_THROW(runAwaitableVoid([this]() -> boost::asio::awaitable<void> {
+        co_await client->getServerTime();
+        co_await client->getVersion();
+    }()));
+
+    const std::vector<boost::json::value> expectedTags = {"1", "2"};
+    EXPECT_EQ(getMockedConnection().customTags, expectedTags);
+}
+
+TEST_F(XStationClientTest, request_pipelined_responses_routed_by_customTag)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .Times(2)
+        .WillRepeatedly([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    // Responses arrive in reverse order
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", true}, {"returnData", "version"}, {"customTag", "2"}};
+        })
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", true}, {"returnData", "serverTime"}, {"customTag", "1"}};
+        });
+
+    boost::json::object serverTimeResult;
+    boost::json::object versionResult;
+    boost::asio::co_spawn(
+        getIoContext(),
+        [&]() -> boost::asio::awaitable<void> { serverTimeResult = co_await client->getServerTime(); },
+        boost::asio::detached);
+    boost::asio::co_spawn(
+        getIoContext(),
+        [&]() -> boost::asio::awaitable<void> { versionResult = co_await client->getVersion(); },
+        boost::asio::detached);
+    getIoContext().run();
+
+    EXPECT_EQ(serverTimeResult["returnData"].as_string(), "serverTime");
+    EXPECT_EQ(versionResult["returnData"].as_string(), "version");
+}
+
+TEST_F(XStationClientTest, request_pipelined_connection_closed)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .Times(2)
+        .WillRepeatedly([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            throw exception::ConnectionClosed("Exception");
+        });
+
+    int failedRequests = 0;
+    for (int i = 0; i < 2; ++i)
+    {
+        boost::asio::co_spawn(
+            getIoContext(),
+            [&]() -> boost::asio::awaitable<void> {
+                try
+                {
+                    co_await client->getServerTime();
+                }
+                catch (const exception::ConnectionClosed &)
+                {
+                    ++failedRequests;
+                }
+            },
+            boost::asio::detached);
+    }
+    getIoContext().run();
+
+    EXPECT_EQ(failedRequests, 2);
+}
+
+TEST_F(XStationClientTest, request_concurrent_threads)
+{
+    constexpr int requestCount = 64;
+
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .Times(requestCount)
+        .WillRepeatedly([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    // Responses without customTag are routed to the oldest waiting request
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .Times(requestCount)
+        .WillRepeatedly([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", true}};
+        });
+
+    std::atomic<int> completedRequests = 0;
+    for (int i = 0; i < requestCount; ++i)
+    {
+        boost::asio::co_spawn(
+            getIoContext(),
+            [&]() -> boost::asio::awaitable<void> {
+                co_await client->getServerTime();
+                ++completedRequests;
+            },
+            boost::asio::detached);
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([this]() { getIoContext().run(); });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(completedRequests, requestCount);
+    EXPECT_EQ(getMockedConnection().customTags.size(), static_cast<std::size_t>(requestCount));
+}
+
+TEST_F(XStationClientTest, request_timeout)
+{
+    client->setRequestTimeout(std::chrono::milliseconds(10));
+
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    // The response arrives after the deadline and is dropped
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, std::chrono::milliseconds(200));
+            co_await timer.async_wait(boost::asio::use_awaitable);
+            co_return boost::json::object{{"status", true}, {"customTag", "1"}};
+        });
+
+    EXPECT_THROW(runAwaitable(client->getServerTime()), exception::RequestTimeout);
+    EXPECT_TRUE(client->m_pendingRequests.empty());
+}
+
+TEST_F(XStationClientTest, request_timeout_while_sending)
+{
+    client->setRequestTimeout(std::chrono::milliseconds(10));
+
+    // The send stalls past the deadline and does not react to the cancellation
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> {
+            boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, std::chrono::milliseconds(200));
+            co_await timer.async_wait(
+                boost::asio::bind_cancellation_slot(boost::asio::cancellation_slot(), boost::asio::use_awaitable));
+        });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse()).Times(0);
+
+    EXPECT_THROW(runAwaitable(client->getServerTime()), exception::RequestTimeout);
+    EXPECT_TRUE(client->m_pendingRequests.empty());
+}
+
+TEST_F(XStationClientTest, withDeadline_per_call)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, std::chrono::milliseconds(200));
+            co_await timer.async_wait(boost::asio::use_awaitable);
+            co_return boost::json::object{{"status", true}, {"customTag", "1"}};
+        });
+
+    EXPECT_THROW(runAwaitable(withDeadline(client->getServerTime(), std::chrono::milliseconds(10))),
+                 exception::RequestTimeout);
+    EXPECT_TRUE(client->m_pendingRequests.empty());
+}
+
+TEST_F(XStationClientTest, withDeadline_response_in_time)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", true}, {"returnData", "serverTime"}, {"customTag", "1"}};
+        });
+
+    boost::json::object result;
+    EXPECT_NO_THROW(result = runAwaitable(withDeadline(client->getServerTime(), std::chrono::seconds(5))));
+    EXPECT_EQ(result["returnData"].as_string(), "serverTime");
+}
+
+TEST_F(XStationClientTest, tryLogin_invalid_account_type)
+{
+    const boost::json::object accountCredentials = {
+        {"accountId", "test"},
+        {"password", "test"},
+        {"accountType", "asdasda"}
+    };
+
+    XStationClient client(getIoContext(), accountCredentials);
+    Result<void> result;
+    EXPECT_NO_THROW(result = runAwaitable(client.tryLogin()));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Errc::LoginFailed);
+}
+
+TEST_F(XStationClientTest, tryGetServerTime_ok)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", true}, {"returnData", "test"}};
+        });
+
+    Result<boost::json::object> result;
+    EXPECT_NO_THROW(result = runAwaitable(client->tryGetServerTime()));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->at("returnData").as_string(), "test");
+}
+
+TEST_F(XStationClientTest, tryGetServerTime_rejected)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", false}, {"errorCode", "BE005"}, {"errorDescr", "Invalid login"}};
+        });
+
+    Result<boost::json::object> result;
+    EXPECT_NO_THROW(result = runAwaitable(client->tryGetServerTime()));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Errc::RequestRejected);
+    EXPECT_EQ(result.error().serverCode, "BE005");
+    EXPECT_EQ(result.error().description, "Invalid login");
+}
+
+TEST_F(XStationClientTest, tryGetServerTime_connection_closed)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> {
+            throw exception::ConnectionClosed("Exception");
+            co_return;
+        });
+
+    Result<boost::json::object> result;
+    EXPECT_NO_THROW(result = runAwaitable(client->tryGetServerTime()));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Errc::ConnectionClosed);
+}
+
+TEST_F(XStationClientTest, tryGetServerTime_timeout)
+{
+    client->setRequestTimeout(std::chrono::milliseconds(10));
+
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, std::chrono::milliseconds(200));
+            co_await timer.async_wait(boost::asio::use_awaitable);
+            co_return boost::json::object{{"status", true}, {"customTag", "1"}};
+        });
+
+    Result<boost::json::object> result;
+    EXPECT_NO_THROW(result = runAwaitable(client->tryGetServerTime()));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Errc::RequestTimeout);
+    EXPECT_TRUE(client->m_pendingRequests.empty());
+}
+
+TEST_F(XStationClientTest, tryTradeTransaction_safeMode)
+{
+    client->setSafeMode(true);
+
+    Result<boost::json::object> result;
+    EXPECT_NO_THROW(result = runAwaitable(client->tryTradeTransaction("EURUSD", TradeCmd::BUY, TradeType::OPEN,
+                                                                      1.1000f, 1.0f, 0.0f, 0.0f, 123456, 0, 0,
+                                                                      "Test comment")));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Errc::RequestRejected);
+    EXPECT_EQ(result.error().serverCode, "N/A");
+}
+
+TEST_F(XStationClientTest, getServerTime_callback)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", true}, {"returnData", "test"}};
+        });
+
+    boost::json::object result;
+    std::exception_ptr eptr;
+    client->async<&XStationClient::getServerTime>([&result, &eptr](std::exception_ptr e, boost::json::object response) {
+        eptr = e;
+        result = std::move(response);
+    });
+    getIoContext().run();
+
+    EXPECT_FALSE(eptr);
+    EXPECT_EQ(result["returnData"].as_string(), "test");
+}
+
+TEST_F(XStationClientTest, getServerTime_callback_exception)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> {
+            throw exception::ConnectionClosed("Exception");
+            co_return;
+        });
+
+    std::exception_ptr eptr;
+    client->async<&XStationClient::getServerTime>([&eptr](std::exception_ptr e, boost::json::object) { eptr = e; });
+    getIoContext().run();
+
+    ASSERT_TRUE(eptr);
+    EXPECT_THROW(std::rethrow_exception(eptr), exception::ConnectionClosed);
+}
+
+TEST_F(XStationClientTest, getSymbol_use_future)
+{
+    const boost::json::object expectedCommand = {{"command", "getSymbol"}, {"arguments", {{"symbol", "EURUSD"}}}};
+
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([&expectedCommand](const boost::json::object &command) -> boost::asio::awaitable<void> {
+            EXPECT_EQ(command, expectedCommand);
+            co_return;
+        });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            co_return boost::json::object{{"status", true}, {"returnData", "symbol"}};
+        });
+
+    // The symbol is a temporary, destroyed before the request is sent
+    auto future = client->async<&XStationClient::getSymbol>(std::string("EURUSD"), boost::asio::use_future);
+    getIoContext().run();
+
+    boost::json::object result;
+    EXPECT_NO_THROW(result = future.get());
+    EXPECT_EQ(result["returnData"].as_string(), "symbol");
+}
+
+TEST_F(XStationClientTest, tryGetServerTime_callback)
+{
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> {
+            throw exception::ConnectionClosed("Exception");
+            co_return;
+        });
+
+    std::optional<Result<boost::json::object>> result;
+    client->async<&XStationClient::tryGetServerTime>([&result](std::exception_ptr eptr, Result<boost::json::object> response) {
+        EXPECT_FALSE(eptr);
+        result = std::move(response);
+    });
+    getIoContext().run();
+
+    ASSERT_TRUE(result.has_value());
+    ASSERT_FALSE(result->has_value());
+    EXPECT_EQ(result->error().code, Errc::ConnectionClosed);
+}
+
 } // namespace xapi
@@ -0,0 +1,198 @@
+#include "MockConnection.hpp"
+#include "xapi/Exceptions.hpp"
+#include "xapi/XStationClientPool.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+namespace xapi
+{
+
+class XStationClientPoolTest : public ::testing::Test
+{
+  protected:
+    static constexpr std::size_t poolSize = 3;
+
+    std::unique_ptr<XStationClientPool> pool;
+
+    void SetUp() override
+    {
+        const boost::json::object accountCredentials = {
+            {"accountId", "test"},
+            {"password", "test"},
+            {"accountType", "demo"}
+        };
+        pool = std::make_unique<XStationClientPool>(m_context, accountCredentials, poolSize);
+        for (std::size_t i = 0; i < poolSize; ++i)
+        {
+            pool->getClient(i).m_connection = std::make_unique<MockConnection>();
+        }
+    }
+
+    void TearDown() override
+    {
+        pool.reset();
+    }
+
+    MockConnection &getMockedConnection(std::size_t index)
+    {
+        return *dynamic_cast<MockConnection *>(pool->getClient(index).m_connection.get());
+    }
+
+    // Expects the given number of requests on the session, each answered after the delay.
+    void expectRequests(std::size_t index, int count, std::chrono::milliseconds delay)
+    {
+        EXPECT_CALL(getMockedConnection(index), makeRequest(testing::_))
+            .Times(count)
+            .WillRepeatedly([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+
+        EXPECT_CALL(getMockedConnection(index), waitResponse())
+            .Times(count)
+            .WillRepeatedly([delay, index]() -> boost::asio::awaitable<boost::json::object> {
+                boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, delay);
+                co_await timer.async_wait(boost::asio::use_awaitable);
+                co_return boost::json::object{{"status", true}, {"returnData", static_cast<std::int64_t>(index)}};
+            });
+    }
+
+    boost::asio::io_context &getIoContext()
+    {
+        return m_context;
+    }
+
+  private:
+    boost::asio::io_context m_context;
+};
+
+TEST(XStationClientPoolConstructorTest, empty_pool)
+{
+    boost::asio::io_context ioContext;
+    const boost::json::object accountCredentials = {
+        {"accountId", "test"},
+        {"password", "test"},
+        {"accountType", "demo"}
+    };
+
+    EXPECT_THROW(XStationClientPool pool(ioContext, accountCredentials, 0), std::invalid_argument);
+}
+
+TEST_F(XStationClientPoolTest, login_all_sessions)
+{
+    for (std::size_t i = 0; i < poolSize; ++i)
+    {
+        EXPECT_CALL(getMockedConnection(i), connect(testing::_))
+            .WillOnce([](const boost::url &url) -> boost::asio::awaitable<void> { co_return; });
+        EXPECT_CALL(getMockedConnection(i), makeRequest(testing::_))
+            .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+        EXPECT_CALL(getMockedConnection(i), waitResponse())
+            .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+                co_return boost::json::object{{"status", true}, {"streamSessionId", "sessionId"}};
+            });
+    }
+
+    boost::asio::co_spawn(getIoContext(), pool->login(), boost::asio::detached);
+    getIoContext().run();
+}
+
+TEST_F(XStationClientPoolTest, login_failed)
+{
+    for (std::size_t i = 0; i < poolSize; ++i)
+    {
+        EXPECT_CALL(getMockedConnection(i), connect(testing::_))
+            .WillOnce([i](const boost::url &url) -> boost::asio::awaitable<void> {
+                if (i == 1)
+                {
+                    throw exception::ConnectionClosed("Exception");
+                }
+                co_return;
+            });
+    }
+    for (std::size_t i : {0, 2})
+    {
+        EXPECT_CALL(getMockedConnection(i), makeRequest(testing::_))
+            .WillOnce([](const boost::json::object &command) -> boost::asio::awaitable<void> { co_return; });
+        EXPECT_CALL(getMockedConnection(i), waitResponse())
+            .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+                co_return boost::json::object{{"status", true}, {"streamSessionId", "sessionId"}};
+            });
+    }
+
+    bool failed = false;
+    boost::asio::co_spawn(
+        getIoContext(),
+        [&]() -> boost::asio::awaitable<void> {
+            try
+            {
+                co_await pool->login();
+            }
+            catch (const exception::ConnectionClosed &)
+            {
+                failed = true;
+            }
+        },
+        boost::asio::detached);
+    getIoContext().run();
+
+    EXPECT_TRUE(failed);
+}
+
+TEST_F(XStationClientPoolTest, concurrent_requests_spread)
+{
+    for (std::size_t i = 0; i < poolSize; ++i)
+    {
+        expectRequests(i, 2, std::chrono::milliseconds(20));
+    }
+
+    std::vector<std::int64_t> sessions;
+    for (std::size_t i = 0; i < 2 * poolSize; ++i)
+    {
+        boost::asio::co_spawn(
+            getIoContext(),
+            [&]() -> boost::asio::awaitable<void> {
+                auto result = co_await pool->getServerTime();
+                sessions.push_back(result["returnData"].as_int64());
+            },
+            boost::asio::detached);
+    }
+    getIoContext().run();
+
+    EXPECT_EQ(sessions.size(), 2 * poolSize);
+    for (std::size_t i = 0; i < poolSize; ++i)
+    {
+        EXPECT_EQ(pool->getLoad(i), 0u);
+    }
+}
+
+TEST_F(XStationClientPoolTest, busy_session_skipped)
+{
+    // Session 0 is busy with a slow request while the others answer at once
+    expectRequests(0, 1, std::chrono::milliseconds(200));
+    expectRequests(1, 2, std::chrono::milliseconds(0));
+    expectRequests(2, 2, std::chrono::milliseconds(0));
+
+    std::vector<std::int64_t> sessions;
+    boost::asio::co_spawn(
+        getIoContext(),
+        [&]() -> boost::asio::awaitable<void> {
+            auto result = co_await pool->getChartRangeRequest("EURUSD", 0, 1, PeriodCode::PERIOD_M1, 0);
+            sessions.push_back(result["returnData"].as_int64());
+        },
+        boost::asio::detached);
+    boost::asio::co_spawn(
+        getIoContext(),
+        [&]() -> boost::asio::awaitable<void> {
+            for (int i = 0; i < 4; ++i)
+            {
+                auto result = co_await pool->getTradingHours({"EURUSD"});
+                sessions.push_back(result["returnData"].as_int64());
+            }
+        },
+        boost::asio::detached);
+    getIoContext().run();
+
+    const std::vector<std::int64_t> expectedSessions = {1, 2, 1, 2, 0};
+    EXPECT_EQ(sessions, expectedSessions);
+}
+
+} // namespace xapi
@@ -2,7 +2,9 @@
 #include "xapi/Exceptions.hpp"
 #include "xapi/XStationClientStream.hpp"
 #include <gtest/gtest.h>
+#include <chrono>
 #include <string>
+#include <vector>
 
 namespace xapi
 {
@@ -23,6 +25,17 @@ class XStationClientStreamTest : public ::testing::Test
         stream.reset();
     }
 
+    // Replaces the stream with one that reconnects after a short delay
+    void enableReconnect(int maxAttempts)
+    {
+        ConnectionOptions options;
+        options.reconnect.enabled = true;
+        options.reconnect.initialDelay = std::chrono::milliseconds(1);
+        options.reconnect.maxAttempts = maxAttempts;
+        stream = std::make_unique<XStationClientStream>(m_context, "demo", "testStreamSessionId", options);
+        stream->m_connection = std::make_unique<MockConnection>();
+    }
+
     MockConnection &getMockedConnection()
     {
         return *dynamic_cast<MockConnection *>(stream->m_connection.get());
@@ -167,6 +180,141 @@ TEST_F(XStationClientStreamTest, listen_exception)
     EXPECT_TRUE(result.empty());
 }
 
+TEST_F(XStationClientStreamTest, tryListen_connection_closed)
+{
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            throw exception::ConnectionClosed("Exception");
+        });
+
+    Result<boost::json::object> result;
+    EXPECT_NO_THROW(result = runAwaitable(stream->tryListen()));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Errc::ConnectionClosed);
+}
+
+TEST_F(XStationClientStreamTest, listen_reconnects_and_replays_subscriptions)
+{
+    enableReconnect(0);
+
+    std::vector<boost::json::object> sentCommands;
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillRepeatedly([&sentCommands](const boost::json::object &command) -> boost::asio::awaitable<void> {
+            sentCommands.push_back(command);
+            co_return;
+        });
+
+    // Open, then one failed reconnect attempt before the successful one
+    EXPECT_CALL(getMockedConnection(), connect(testing::_))
+        .WillOnce([](const boost::url &) -> boost::asio::awaitable<void> { co_return; })
+        .WillOnce([](const boost::url &) -> boost::asio::awaitable<void> {
+            throw exception::ConnectionClosed("Exception");
+        })
+        .WillOnce([](const boost::url &) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            throw exception::ConnectionClosed("Exception");
+        });
+
+    boost::json::object result;
+    EXPECT_NO_THROW(result = runAwaitable([this]() -> boost::asio::awaitable<boost::json::object> {
+        co_await stream->open();
+        co_await stream->getTickPrices("EURUSD");
+        co_await stream->getTrades();
+        co_await stream->stopTrades();
+        sentCommands.clear();
+        co_return co_await stream->listen();
+    }()));
+
+    const std::vector<boost::json::object> expectedCommands = {
+        {{"command", "getTickPrices"},
+         {"streamSessionId", "testStreamSessionId"},
+         {"symbol", "EURUSD"},
+         {"minArrivalTime", 0},
+         {"maxLevel", 2}}};
+    EXPECT_EQ(sentCommands, expectedCommands);
+
+    EXPECT_EQ(result.at("command"), "gap");
+    EXPECT_EQ(result.at("data").at("reconnectAttempts").to_number<int>(), 2);
+    EXPECT_EQ(result.at("data").at("subscriptions").to_number<int>(), 1);
+}
+
+TEST_F(XStationClientStreamTest, listen_replays_subscriptions_in_order)
+{
+    enableReconnect(0);
+
+    std::vector<boost::json::object> sentCommands;
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillRepeatedly([&sentCommands](const boost::json::object &command) -> boost::asio::awaitable<void> {
+            sentCommands.push_back(command);
+            co_return;
+        });
+
+    EXPECT_CALL(getMockedConnection(), connect(testing::_))
+        .WillRepeatedly([](const boost::url &) -> boost::asio::awaitable<void> { co_return; });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            throw exception::ConnectionClosed("Exception");
+        });
+
+    EXPECT_NO_THROW(runAwaitable([this]() -> boost::asio::awaitable<boost::json::object> {
+        co_await stream->open();
+        co_await stream->getTrades();
+        co_await stream->getTickPrices("EURUSD");
+        co_await stream->getNews();
+        co_await stream->getTickPrices("EURUSD", 100);
+        co_await stream->stopTrades();
+        sentCommands.clear();
+        co_return co_await stream->listen();
+    }()));
+
+    // In the order subscribed, a repeated subscription keeps its place
+    const std::vector<boost::json::object> expectedCommands = {
+        {{"command", "getTickPrices"},
+         {"streamSessionId", "testStreamSessionId"},
+         {"symbol", "EURUSD"},
+         {"minArrivalTime", 100},
+         {"maxLevel", 2}},
+        {{"command", "getNews"}, {"streamSessionId", "testStreamSessionId"}}};
+    EXPECT_EQ(sentCommands, expectedCommands);
+}
+
+TEST_F(XStationClientStreamTest, listen_reconnect_gives_up_after_max_attempts)
+{
+    enableReconnect(2);
+
+    EXPECT_CALL(getMockedConnection(), connect(testing::_))
+        .WillOnce([](const boost::url &) -> boost::asio::awaitable<void> { co_return; })
+        .WillRepeatedly([](const boost::url &) -> boost::asio::awaitable<void> {
+            throw exception::ConnectionClosed("Exception");
+        });
+
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            throw exception::ConnectionClosed("Exception");
+        });
+
+    EXPECT_THROW(runAwaitable([this]() -> boost::asio::awaitable<boost::json::object> {
+        co_await stream->open();
+        co_return co_await stream->listen();
+    }()), exception::ConnectionClosed);
+}
+
+TEST_F(XStationClientStreamTest, listen_closed_stream_not_reconnected)
+{
+    enableReconnect(0);
+
+    EXPECT_CALL(getMockedConnection(), connect(testing::_)).Times(0);
+    EXPECT_CALL(getMockedConnection(), waitResponse())
+        .WillOnce([]() -> boost::asio::awaitable<boost::json::object> {
+            throw exception::ConnectionClosed("Exception");
+        });
+
+    EXPECT_THROW(runAwaitable(stream->listen()), exception::ConnectionClosed);
+}
+
 TEST_F(XStationClientStreamTest, getBalance_ok)
 {
     const boost::json::object expectedCommand = {
@@ -183,6 +331,23 @@ TEST_F(XStationClientStreamTest, getBalance_ok)
     EXPECT_NO_THROW(runAwaitableVoid(stream->getBalance()));
 }
 
+TEST_F(XStationClientStreamTest, setStreamSessionId)
+{
+    const boost::json::object expectedCommand = {
+        {"command", "getBalance"},
+        {"streamSessionId", "newStreamSessionId"}
+    };
+
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([&expectedCommand](const boost::json::object &command) -> boost::asio::awaitable<void> {
+            EXPECT_EQ(command, expectedCommand);
+            co_return;
+        });
+
+    stream->setStreamSessionId("newStreamSessionId");
+    EXPECT_NO_THROW(runAwaitableVoid(stream->getBalance()));
+}
+
 TEST_F(XStationClientStreamTest, getBalance_exception)
 {
     EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
@@ -453,6 +618,33 @@ TEST_F(XStationClientStreamTest, getTickPrices_ok)
     EXPECT_NO_THROW(runAwaitableVoid(stream->getTickPrices(symbol, minArrivalTime, maxLevel)));
 }
 
+TEST_F(XStationClientStreamTest, getTickPrices_callback)
+{
+    const boost::json::object expectedCommand = {
+        {"command", "getTickPrices"},
+        {"streamSessionId", "testStreamSessionId"},
+        {"symbol", "EURUSD"},
+        {"minArrivalTime", 500},
+        {"maxLevel", 2}
+    };
+
+    EXPECT_CALL(getMockedConnection(), makeRequest(testing::_))
+        .WillOnce([&expectedCommand](const boost::json::object &command) -> boost::asio::awaitable<void> {
+            EXPECT_EQ(command, expectedCommand);
+            co_return;
+        });
+
+    // The symbol is a temporary, destroyed before the subscription is sent
+    bool completed = false;
+    stream->async<&XStationClientStream::getTickPrices>(std::string("EURUSD"), 500, 2, [&completed](std::exception_ptr eptr) {
+        EXPECT_FALSE(eptr);
+        completed = true;
+    });
+    getIoContext().run();
+
+    EXPECT_TRUE(completed);
+}
+
 TEST_F(XStationClientStreamTest, getTickPrices_exception)
 {
     const std::string symbol = "EURUSD";
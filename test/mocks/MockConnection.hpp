@@ -2,6 +2,7 @@
 
 #include <gmock/gmock.h>
 #include "xapi/IConnection.hpp"
+#include <vector>
 
 class MockConnection : public xapi::internals::IConnection
 {
@@ -15,6 +16,25 @@ public:
     // Mock the makeRequest method
     MOCK_METHOD((boost::asio::awaitable<void>), makeRequest, (const boost::json::object &command), (override));
 
+    // Parses serialized commands and forwards them to makeRequest, so tests can check every command as JSON.
+    // The customTag added to requests is moved to customTags, to keep the expected commands independent of it.
+    boost::asio::awaitable<void> sendMessage(std::string_view message) override
+    {
+        boost::json::object command = boost::json::parse(message).as_object();
+        if (auto *customTag = command.if_contains("customTag"))
+        {
+            customTags.push_back(*customTag);
+            command.erase("customTag");
+        }
+        co_await makeRequest(command);
+    }
+
+    // customTags of the commands sent so far
+    std::vector<boost::json::value> customTags;
+
     // Mock the waitResponse method
     MOCK_METHOD((boost::asio::awaitable<boost::json::object>), waitResponse, (), (override));
+
+    // Mock the getRttHistogram method
+    MOCK_METHOD((std::shared_ptr<const xapi::LatencyHistogram>), getRttHistogram, (), (const, override));
 };
@@ -0,0 +1,39 @@
+#include "CommandSerializer.hpp"
+#include <algorithm>
+
+namespace xapi
+{
+namespace internals
+{
+
+namespace
+{
+
+// Capacity reserved when the buffer is serialized into for the first time.
+constexpr std::size_t initialBufferSize = 256;
+
+} // namespace
+
+CommandSerializer::CommandSerializer() : m_scratch(), m_serializer({}, m_scratch.data(), m_scratch.size())
+{
+}
+
+void CommandSerializer::serialize(const boost::json::object &command, std::string &buffer)
+{
+    buffer.clear();
+    m_serializer.reset(&command);
+    while (!m_serializer.done())
+    {
+        // Expose the whole capacity for writing and grow only when it is exhausted
+        const std::size_t offset = buffer.size();
+        const std::size_t size =
+            buffer.capacity() > offset ? buffer.capacity() : std::max(2 * offset, initialBufferSize);
+        buffer.resize(size);
+
+        const auto written = m_serializer.read(buffer.data() + offset, size - offset);
+        buffer.resize(offset + written.size());
+    }
+}
+
+} // namespace internals
+} // namespace xapi
@@ -0,0 +1,53 @@
+#pragma once
+
+/**
+ * @file CommandSerializer.hpp
+ * @brief Defines the CommandSerializer class for serializing outgoing commands.
+ */
+
+#include <boost/json.hpp>
+#include <array>
+#include <string>
+
+namespace xapi
+{
+namespace internals
+{
+
+/**
+ * @class CommandSerializer
+ * @brief Serializes commands into a reusable buffer.
+ *
+ * The serializer keeps its internal stack in a fixed scratch area and writes into a buffer
+ * provided by the caller. The buffer keeps its capacity between commands, so once it has grown
+ * to the size of the largest command, serializing does not allocate.
+ */
+class CommandSerializer final
+{
+  public:
+    CommandSerializer();
+
+    CommandSerializer(const CommandSerializer &) = delete;
+    CommandSerializer &operator=(const CommandSerializer &) = delete;
+
+    CommandSerializer(CommandSerializer &&) = delete;
+    CommandSerializer &operator=(CommandSerializer &&) = delete;
+
+    ~CommandSerializer() = default;
+
+    /**
+     * @brief Serializes the command into the buffer, replacing its content.
+     * @param command The command to serialize.
+     * @param buffer The buffer to write to.
+     */
+    void serialize(const boost::json::object &command, std::string &buffer);
+
+  private:
+    // Scratch area for the serializer's internal stack, deep enough for every xAPI command.
+    std::array<unsigned char, 256> m_scratch;
+
+    boost::json::serializer m_serializer;
+};
+
+} // namespace internals
+} // namespace xapi
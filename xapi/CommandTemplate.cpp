@@ -0,0 +1,146 @@
+#include "CommandTemplate.hpp"
+#include <charconv>
+#include <cmath>
+
+namespace xapi
+{
+namespace internals
+{
+
+namespace
+{
+
+template <typename Number> void appendNumber(std::string &buffer, Number value)
+{
+    char text[32];
+    const auto result = std::to_chars(std::begin(text), std::end(text), value);
+    buffer.append(text, result.ptr);
+}
+
+template <typename Values> void appendArray(std::string &buffer, const Values &values)
+{
+    buffer.push_back('[');
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        if (i != 0)
+        {
+            buffer.push_back(',');
+        }
+        appendJson(buffer, values[i]);
+    }
+    buffer.push_back(']');
+}
+
+} // namespace
+
+void appendJson(std::string &buffer, bool value)
+{
+    buffer.append(value ? "true" : "false");
+}
+
+void appendJson(std::string &buffer, int value)
+{
+    appendNumber(buffer, value);
+}
+
+void appendJson(std::string &buffer, std::int64_t value)
+{
+    appendNumber(buffer, value);
+}
+
+void appendJson(std::string &buffer, float value)
+{
+    // Written as double, the same way boost::json stores a float
+    appendJson(buffer, static_cast<double>(value));
+}
+
+void appendJson(std::string &buffer, double value)
+{
+    if (!std::isfinite(value))
+    {
+        buffer.append("null");
+        return;
+    }
+
+    const std::size_t begin = buffer.size();
+    appendNumber(buffer, value);
+    // Integral values keep a fraction, so they are still read back as doubles
+    if (std::string_view(buffer).substr(begin).find_first_of(".e") == std::string_view::npos)
+    {
+        buffer.append(".0");
+    }
+}
+
+void appendJson(std::string &buffer, std::string_view value)
+{
+    static constexpr char hexDigits[] = "0123456789abcdef";
+
+    buffer.push_back('"');
+    for (const char character : value)
+    {
+        switch (character)
+        {
+        case '"':
+            buffer.append("\\\"");
+            break;
+        case '\\':
+            buffer.append("\\\\");
+            break;
+        case '\b':
+            buffer.append("\\b");
+            break;
+        case '\f':
+            buffer.append("\\f");
+            break;
+        case '\n':
+            buffer.append("\\n");
+            break;
+        case '\r':
+            buffer.append("\\r");
+            break;
+        case '\t':
+            buffer.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(character) < 0x20)
+            {
+                buffer.append("\\u00");
+                buffer.push_back(hexDigits[(character >> 4) & 0x0f]);
+                buffer.push_back(hexDigits[character & 0x0f]);
+            }
+            else
+            {
+                buffer.push_back(character);
+            }
+        }
+    }
+    buffer.push_back('"');
+}
+
+void appendJson(std::string &buffer, const char *value)
+{
+    appendJson(buffer, std::string_view(value));
+}
+
+void appendJson(std::string &buffer, const std::string &value)
+{
+    appendJson(buffer, std::string_view(value));
+}
+
+void appendJson(std::string &buffer, const std::vector<std::string> &values)
+{
+    appendArray(buffer, values);
+}
+
+void appendJson(std::string &buffer, const std::vector<int> &values)
+{
+    appendArray(buffer, values);
+}
+
+void appendJson(std::string &buffer, RawJson value)
+{
+    buffer.append(value.text);
+}
+
+} // namespace internals
+} // namespace xapi
@@ -0,0 +1,116 @@
+#pragma once
+
+/**
+ * @file CommandTemplate.hpp
+ * @brief Defines the CommandTemplate class for rendering pre-serialized commands.
+ *
+ * This file contains the definition of the CommandTemplate class and of the functions
+ * used to write command arguments as JSON into a send buffer.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace xapi
+{
+namespace internals
+{
+
+/**
+ * @brief Already serialized JSON, written into a command as is.
+ */
+struct RawJson
+{
+    std::string_view text;
+};
+
+/**
+ * @brief Appends a value to the buffer as JSON.
+ * @param buffer The buffer to append to.
+ * @param value The value to append.
+ */
+void appendJson(std::string &buffer, bool value);
+void appendJson(std::string &buffer, int value);
+void appendJson(std::string &buffer, std::int64_t value);
+void appendJson(std::string &buffer, float value);
+void appendJson(std::string &buffer, double value);
+void appendJson(std::string &buffer, std::string_view value);
+void appendJson(std::string &buffer, const char *value);
+void appendJson(std::string &buffer, const std::string &value);
+void appendJson(std::string &buffer, const std::vector<std::string> &values);
+void appendJson(std::string &buffer, const std::vector<int> &values);
+void appendJson(std::string &buffer, RawJson value);
+
+/**
+ * @class CommandTemplate
+ * @brief Serialized command skeleton with slots for the variable arguments.
+ *
+ * The skeleton is split at compile time into constant fragments. Rendering a command copies
+ * the fragments into the buffer and writes only the slot values in between, instead of building
+ * and serializing a boost::json::object on every call.
+ *
+ * @tparam Slots The number of slots in the skeleton, checked at compile time.
+ */
+template <std::size_t Slots> class CommandTemplate final
+{
+  public:
+    /**
+     * @brief Splits the skeleton into constant fragments.
+     * @param skeleton Serialized command in which every `?` marks a slot.
+     */
+    consteval explicit CommandTemplate(std::string_view skeleton) : m_fragments()
+    {
+        std::size_t slot = 0;
+        std::size_t fragmentBegin = 0;
+        for (std::size_t i = 0; i < skeleton.size(); ++i)
+        {
+            if (skeleton[i] == m_slotMarker)
+            {
+                if (slot == Slots)
+                {
+                    throw std::logic_error("Command template has more slots than declared");
+                }
+                m_fragments[slot++] = skeleton.substr(fragmentBegin, i - fragmentBegin);
+                fragmentBegin = i + 1;
+            }
+        }
+        if (slot != Slots)
+        {
+            throw std::logic_error("Command template has less slots than declared");
+        }
+        m_fragments[Slots] = skeleton.substr(fragmentBegin);
+    }
+
+    /**
+     * @brief Renders the command into the buffer, replacing its content.
+     * @param buffer The buffer to render into. Its capacity is reused.
+     * @param args The slot values, in the order of the slots in the skeleton.
+     */
+    template <typename... Args> void render(std::string &buffer, const Args &...args) const
+    {
+        static_assert(sizeof...(Args) == Slots, "Every slot of the command template needs a value");
+        buffer.clear();
+        buffer.append(m_fragments[0]);
+        renderSlots(buffer, std::make_index_sequence<Slots>(), args...);
+    }
+
+  private:
+    template <std::size_t... Index, typename... Args>
+    void renderSlots([[maybe_unused]] std::string &buffer, std::index_sequence<Index...>, const Args &...args) const
+    {
+        ((appendJson(buffer, args), buffer.append(m_fragments[Index + 1])), ...);
+    }
+
+    static constexpr char m_slotMarker = '?';
+
+    std::array<std::string_view, Slots + 1> m_fragments;
+};
+
+} // namespace internals
+} // namespace xapi
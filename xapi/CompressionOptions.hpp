@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @file CompressionOptions.hpp
+ * @brief Defines the options of the WebSocket permessage-deflate extension.
+ */
+
+#include <cstddef>
+
+namespace xapi
+{
+
+/**
+ * @brief Options of the permessage-deflate extension (RFC 7692) offered by the connections.
+ *
+ * Compression pays off for large responses such as getAllSymbols, getCalendar or getTradesHistory,
+ * at the cost of CPU time for inflating them. The server may decline the offer, in which case
+ * messages are sent uncompressed.
+ */
+struct CompressionOptions
+{
+    /**
+     * Flag to offer permessage-deflate in the WebSocket handshake. Disabled by default.
+     */
+    bool enabled = false;
+
+    /**
+     * Base two logarithm of the LZ77 window the server compresses with, from 9 to 15.
+     * Smaller windows save memory on both sides and compress worse.
+     */
+    int serverMaxWindowBits = 15;
+
+    /**
+     * Base two logarithm of the LZ77 window the client compresses with, from 9 to 15.
+     */
+    int clientMaxWindowBits = 15;
+
+    /**
+     * Asks the server to reset its compression context after every message, which saves
+     * memory at the cost of the compression ratio.
+     */
+    bool serverNoContextTakeover = false;
+
+    /**
+     * Resets the compression context of the client after every message.
+     */
+    bool clientNoContextTakeover = false;
+
+    /**
+     * zlib memory level of the client compressor, from 1 (least memory) to 9 (fastest).
+     */
+    int memoryLevel = 4;
+
+    /**
+     * zlib compression level of the client compressor, from 0 (none) to 9 (best).
+     */
+    int compressionLevel = 6;
+
+    /**
+     * Outgoing messages smaller than this are sent uncompressed. Commands are small, so by default
+     * only the responses are compressed in practice.
+     */
+    std::size_t minMessageSize = 1024;
+};
+
+} // namespace xapi
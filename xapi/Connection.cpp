@@ -1,169 +1,606 @@
 #include "Connection.hpp"
+#include "EndpointRace.hpp"
 #include "Exceptions.hpp"
+#include <algorithm>
 #include <iostream>
 
+#if defined(__linux__)
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
 namespace xapi
 {
 namespace internals
 {
 
-Connection::Connection(boost::asio::io_context &ioContext)
-    : m_ioContext(ioContext), m_sslContext(boost::asio::ssl::context::tlsv13_client),
-      m_websocket(m_ioContext, m_sslContext), m_cancellationSignal(),
-      m_lastRequestTime(std::chrono::system_clock::now()), m_requestTimeout(200), m_websocketDefaultPort("443")
+namespace
+{
+
+// Translates the compression options into the permessage-deflate settings of beast.
+boost::beast::websocket::permessage_deflate makeDeflateOptions(const CompressionOptions &options)
+{
+    boost::beast::websocket::permessage_deflate deflate;
+    deflate.client_enable = options.enabled;
+    deflate.server_max_window_bits = options.serverMaxWindowBits;
+    deflate.client_max_window_bits = options.clientMaxWindowBits;
+    deflate.server_no_context_takeover = options.serverNoContextTakeover;
+    deflate.client_no_context_takeover = options.clientNoContextTakeover;
+    deflate.memLevel = options.memoryLevel;
+    deflate.compLevel = options.compressionLevel;
+    deflate.msg_size_threshold = options.minMessageSize;
+    return deflate;
+}
+
+// Ports used when the URL has none.
+const std::string defaultTlsPort = "443";
+const std::string defaultPlainPort = "80";
+
+// Context used by connections that are not given one, created once for the whole process.
+std::shared_ptr<boost::asio::ssl::context> sharedSslContext()
 {
+    static const auto sslContext =
+        std::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tlsv13_client);
+    return sslContext;
 }
 
-Connection::Connection(Connection &&other) noexcept
-    : m_ioContext(other.m_ioContext),
-      m_sslContext(std::move(other.m_sslContext)),
-      m_websocket(std::move(other.m_websocket)),
-      m_lastRequestTime(std::move(other.m_lastRequestTime)),
-      m_requestTimeout(other.m_requestTimeout),
-      m_websocketDefaultPort(std::move(other.m_websocketDefaultPort))
+} // namespace
+
+Connection::Connection(boost::asio::io_context &ioContext, const ConnectionOptions &options)
+    : Connection(boost::asio::make_strand(ioContext), options)
 {
 }
 
+Connection::Connection(const Strand &strand, const ConnectionOptions &options)
+    : m_ioContext(strand.context()), m_strand(strand),
+      m_sslContext(options.sslContext ? options.sslContext : sharedSslContext()),
+      m_websocket(std::make_shared<Websocket>(std::in_place_type<TlsWebsocket>, m_strand, *m_sslContext)),
+      m_alive(std::make_shared<std::atomic<bool>>(true)), m_readBuffer(), m_jsonParser(), m_commandSerializer(),
+      m_writeBuffer(), m_writeQueue(), m_spareBuffers(), m_nextMessageId(0), m_writing(false),
+      m_writerIdle(m_strand, boost::asio::steady_timer::time_point::max()),
+      m_coalesceWrites(options.coalesceWrites),
+      m_keepAliveStop(std::make_shared<boost::asio::cancellation_signal>()),
+      m_keepAliveInterval(options.keepAliveInterval), m_rttHistogram(std::make_shared<LatencyHistogram>()),
+      m_pingSequence(0), m_pingSentAt(),
+      m_rateLimiter(options.rateLimiter ? options.rateLimiter : std::make_shared<RateLimiter>()),
+      m_tlsSessionCache(options.tlsSessionCache), m_resolverCache(options.resolverCache),
+      m_connectAttemptDelay(options.connectAttemptDelay), m_socketOptions(options.socket),
+      m_deflateOptions(makeDeflateOptions(options.compression))
+{
+    if (m_tlsSessionCache)
+    {
+        TlsSessionCache::attach(m_sslContext->native_handle());
+    }
+}
+
 Connection::~Connection()
 {
-    m_cancellationSignal.emit(boost::asio::cancellation_type::all);
-    if (m_websocket.is_open())
+    // Detached coroutines and handlers of the connection stop at their next check
+    m_alive->store(false);
+
+    if (m_ioContext.stopped())
     {
-        try
-        {
-            // Attempt a graceful WebSocket closure
-            m_websocket.close(boost::beast::websocket::close_code::normal);
-        }
-        catch (const boost::system::system_error &e)
+        // Nothing runs on the strand, so the stream is closed here and at once
+        m_keepAliveStop->emit(boost::asio::cancellation_type::all);
+        if (isOpen())
         {
-            std::cerr << "Fatal error: " << e.what() << std::endl;
+            try
+            {
+                // Attempt a graceful WebSocket closure
+                std::visit([](auto &websocket) { websocket.close(boost::beast::websocket::close_code::normal); },
+                           *m_websocket);
+            }
+            catch (const boost::system::system_error &e)
+            {
+                std::cerr << "Fatal error: " << e.what() << std::endl;
+            }
         }
+        boost::system::error_code ignored;
+        tcpStream().socket().close(ignored);
+        return;
     }
+
+    // The stream and the keep-alive are used on the strand, so they are stopped there. The teardown
+    // owns what it touches, the connection is gone by the time it runs.
+    boost::asio::dispatch(m_strand, [websocket = m_websocket, keepAliveStop = m_keepAliveStop]() {
+        keepAliveStop->emit(boost::asio::cancellation_type::all);
+        std::visit(
+            [&websocket](auto &stream) {
+                if (stream.is_open())
+                {
+                    // Attempt a graceful WebSocket closure, the handler holds the stream until it is done
+                    stream.async_close(boost::beast::websocket::close_code::normal,
+                                       [websocket](boost::system::error_code) {});
+                }
+                else
+                {
+                    // Fails a write of the writer, which may still hold the stream
+                    boost::system::error_code ignored;
+                    boost::beast::get_lowest_layer(stream).socket().close(ignored);
+                }
+            },
+            *websocket);
+    });
 }
 
 boost::asio::awaitable<void> Connection::connect(const boost::url &url)
 {
-    const auto executor = co_await boost::asio::this_coro::executor;
-    try
-    {
-        boost::asio::ip::tcp::resolver resolver(executor);
-        auto const results =
-            co_await resolver.async_resolve(url.host(), m_websocketDefaultPort, boost::asio::use_awaitable);
+    internals::unwrap(co_await tryConnect(url));
+}
 
-        co_await establishSSLConnection(results, url.host().c_str());
+boost::asio::awaitable<Result<void>> Connection::tryConnect(const boost::url &url)
+{
+    return internals::runOnStrand(m_strand, [this, &url]() -> boost::asio::awaitable<Result<void>> {
+        // Stops the keep-alive and the writer of a previous connection. A stream cannot be reused
+        // once it failed or was closed, so every connect starts from a fresh one. Closing the old
+        // socket fails a ping or a write still in progress on it, they hold the old stream until then.
+        stopKeepAlive();
+        boost::system::error_code ignored;
+        tcpStream().socket().close(ignored);
+        co_await stopWriting();
+        const bool useTls = url.scheme_id() != boost::urls::scheme::ws;
+        if (useTls)
+        {
+            m_websocket = std::make_shared<Websocket>(std::in_place_type<TlsWebsocket>, m_strand, *m_sslContext);
+        }
+        else
+        {
+            m_websocket = std::make_shared<Websocket>(std::in_place_type<PlainWebsocket>, m_strand);
+        }
+        std::visit(
+            [this](auto &websocket) {
+                websocket.control_callback(
+                    [this, alive = m_alive](boost::beast::websocket::frame_type kind, boost::beast::string_view payload) {
+                        // Also called by the closing handshake of the destructor, which outlives this
+                        if (*alive && kind == boost::beast::websocket::frame_type::pong)
+                        {
+                            onPong(payload);
+                        }
+                    });
+                websocket.set_option(m_deflateOptions);
+                websocket.set_option(
+                    boost::beast::websocket::stream_base::timeout::suggested(boost::beast::role_type::client));
+            },
+            *m_websocket);
+        m_pingSentAt.reset();
 
-        m_websocket.set_option(
-            boost::beast::websocket::stream_base::timeout::suggested(boost::beast::role_type::client));
+        boost::system::error_code error;
+        const std::string host = url.host();
+        const std::string port = url.has_port() ? std::string(url.port()) : (useTls ? defaultTlsPort : defaultPlainPort);
+        co_await establishTcpConnection(host, port, error);
 
-        co_await m_websocket.async_handshake(url.host(), url.path(), boost::asio::use_awaitable);
+        if (!error && useTls)
+        {
+            co_await establishSSLConnection(host, port, error);
+        }
+
+        if (!error)
+        {
+            const std::string path = url.path().empty() ? "/" : std::string(url.path());
+            co_await std::visit(
+                [&host, &path, &error](auto &websocket) {
+                    return websocket.async_handshake(host, path,
+                                                     boost::asio::redirect_error(boost::asio::use_awaitable, error));
+                },
+                *m_websocket);
+        }
+
+        if (error)
+        {
+            co_return Error::make(Errc::ConnectionClosed, error.message(), error);
+        }
 
         // Start sending periodic ping messages to keep the connection alive
-        boost::asio::co_spawn(executor, startKeepAlive(m_cancellationSignal.slot()), boost::asio::detached);
+        boost::asio::co_spawn(m_strand, startKeepAlive(m_keepAliveStop), boost::asio::detached);
+        co_return Result<void>();
+    });
+};
+
+boost::asio::awaitable<ResolverCache::Endpoints> Connection::resolve(const std::string &host, const std::string &port,
+                                                                     boost::system::error_code &error)
+{
+    if (m_resolverCache)
+    {
+        co_return co_await m_resolverCache->resolve(host, port, error);
     }
-    catch (const boost::system::system_error &e)
+
+    boost::asio::ip::tcp::resolver resolver(m_strand);
+    const auto results =
+        co_await resolver.async_resolve(host, port, boost::asio::redirect_error(boost::asio::use_awaitable, error));
+    ResolverCache::Endpoints endpoints;
+    for (const auto &result : results)
     {
-        throw exception::ConnectionClosed(e.what());
+        endpoints.push_back(result.endpoint());
     }
-};
+    co_return endpoints;
+}
 
-boost::asio::awaitable<void> Connection::establishSSLConnection(
-    const boost::asio::ip::tcp::resolver::results_type &results, const char *host)
+boost::asio::awaitable<void> Connection::establishTcpConnection(const std::string &host, const std::string &port,
+                                                                boost::system::error_code &error)
 {
-    try
+    const auto endpoints = co_await resolve(host, port, error);
+    if (error)
     {
-        auto &tcpStream = boost::beast::get_lowest_layer(m_websocket);
-        co_await tcpStream.async_connect(results, boost::asio::use_awaitable);
-        tcpStream.expires_after(std::chrono::seconds(30));
+        co_return;
+    }
 
-        auto &sslStream = m_websocket.next_layer();
-        if (!SSL_set_tlsext_host_name(sslStream.native_handle(), host))
+    tcpStream().socket() = co_await raceConnect(m_strand, endpoints, m_connectAttemptDelay, error);
+    if (error)
+    {
+        if (m_resolverCache)
         {
-            boost::beast::error_code ec(static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category());
-            throw boost::beast::system_error{ec};
+            // None of the endpoints could be reached, they may have moved
+            m_resolverCache->invalidate(host, port);
         }
-        co_await sslStream.async_handshake(boost::asio::ssl::stream_base::client, boost::asio::use_awaitable);
-        tcpStream.expires_never();
+        co_return;
+    }
+    applySocketOptions(error);
+}
+
+void Connection::applySocketOptions(boost::system::error_code &error)
+{
+    auto &socket = tcpStream().socket();
+    socket.set_option(boost::asio::ip::tcp::no_delay(m_socketOptions.noDelay), error);
+    if (!error && m_socketOptions.receiveBufferSize)
+    {
+        socket.set_option(boost::asio::socket_base::receive_buffer_size(*m_socketOptions.receiveBufferSize), error);
+    }
+    if (!error && m_socketOptions.sendBufferSize)
+    {
+        socket.set_option(boost::asio::socket_base::send_buffer_size(*m_socketOptions.sendBufferSize), error);
     }
-    catch (const boost::system::system_error &e)
+#if defined(__linux__) && defined(SO_BUSY_POLL)
+    if (!error && m_socketOptions.busyPoll)
     {
-        throw exception::ConnectionClosed(e.what());
+        // Best effort, raising it above the system default fails with EPERM without CAP_NET_ADMIN
+        const int busyPoll = *m_socketOptions.busyPoll;
+        ::setsockopt(socket.native_handle(), SOL_SOCKET, SO_BUSY_POLL, &busyPoll, sizeof(busyPoll));
     }
+#endif
+    rearmQuickAck();
 }
 
-boost::asio::awaitable<void> Connection::disconnect()
+void Connection::rearmQuickAck()
 {
-    m_cancellationSignal.emit(boost::asio::cancellation_type::all);
-    try
+#if defined(__linux__) && defined(TCP_QUICKACK)
+    if (m_socketOptions.quickAck)
     {
-        co_await m_websocket.async_close(boost::beast::websocket::close_code::normal, boost::asio::use_awaitable);
+        // Best effort, a failure only costs a delayed acknowledgement
+        const int quickAck = 1;
+        ::setsockopt(tcpStream().socket().native_handle(), IPPROTO_TCP, TCP_QUICKACK, &quickAck, sizeof(quickAck));
     }
-    catch (const boost::system::system_error &e)
+#endif
+}
+
+boost::asio::awaitable<void> Connection::establishSSLConnection(const std::string &host, const std::string &port,
+                                                                boost::system::error_code &error)
+{
+    auto &websocket = std::get<TlsWebsocket>(*m_websocket);
+    auto &tcpStream = boost::beast::get_lowest_layer(websocket);
+    tcpStream.expires_after(std::chrono::seconds(30));
+
+    auto &sslStream = websocket.next_layer().next_layer();
+    if (!SSL_set_tlsext_host_name(sslStream.native_handle(), host.c_str()))
     {
-        if (e.code() == boost::asio::error::operation_aborted || e.code() == boost::asio::error::eof)
-        {
-            // operation_aborted or eof is expected when the connection is closed by remote peer
-            co_return;
-        }
+        error.assign(static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category());
+        co_return;
     }
+    if (m_tlsSessionCache)
+    {
+        // Abbreviated handshake if the server issued a session to an earlier connection
+        m_tlsSessionCache->resume(sslStream.native_handle(), host, port);
+    }
+    co_await sslStream.async_handshake(boost::asio::ssl::stream_base::client,
+                                       boost::asio::redirect_error(boost::asio::use_awaitable, error));
+    tcpStream.expires_never();
+}
+
+boost::asio::awaitable<void> Connection::disconnect()
+{
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<void> {
+        stopKeepAlive();
+        // operation_aborted or eof is expected when the connection is closed by remote peer
+        boost::system::error_code ignored;
+        co_await std::visit(
+            [&ignored](auto &websocket) {
+                return websocket.async_close(boost::beast::websocket::close_code::normal,
+                                             boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
+            },
+            *m_websocket);
+    });
 };
 
 boost::asio::awaitable<void> Connection::makeRequest(const boost::json::object &command)
 {
-    const auto currentTime = std::chrono::system_clock::now();
-    const auto duration = currentTime - m_lastRequestTime;
-    if (duration < m_requestTimeout)
+    return internals::runOnStrand(m_strand, [this, &command]() -> boost::asio::awaitable<void> {
+        m_commandSerializer.serialize(command, m_writeBuffer);
+        co_await sendMessage(m_writeBuffer);
+    });
+}
+
+boost::asio::awaitable<void> Connection::sendMessage(std::string_view message)
+{
+    internals::unwrap(co_await trySendMessage(message));
+}
+
+boost::asio::awaitable<Result<void>> Connection::trySendMessage(std::string_view message)
+{
+    return internals::runOnStrand(m_strand, [this, message]() -> boost::asio::awaitable<Result<void>> {
+        const auto [error] = co_await boost::asio::async_initiate<
+            const boost::asio::as_tuple_t<boost::asio::use_awaitable_t<>> &, void(boost::system::error_code)>(
+            [this, message](auto handler) {
+                OutgoingMessage outgoingMessage;
+                if (!m_spareBuffers.empty())
+                {
+                    outgoingMessage.payload = std::move(m_spareBuffers.back());
+                    m_spareBuffers.pop_back();
+                }
+                outgoingMessage.payload.assign(message);
+                outgoingMessage.id = m_nextMessageId++;
+
+                // A canceled message is dropped while it waits in the queue, once written it completes as usual
+                auto cancellationSlot = boost::asio::get_associated_cancellation_slot(handler);
+                if (cancellationSlot.is_connected())
+                {
+                    cancellationSlot.assign([this, alive = m_alive, id = outgoingMessage.id](
+                                                boost::asio::cancellation_type) {
+                        if (*alive)
+                        {
+                            cancelMessage(id);
+                        }
+                    });
+                }
+                outgoingMessage.handler = WriteHandler(std::move(handler));
+                m_writeQueue.push_back(std::move(outgoingMessage));
+
+                if (!m_writing)
+                {
+                    m_writing = true;
+                    boost::asio::co_spawn(m_strand, writeMessages(), boost::asio::detached);
+                }
+            },
+            boost::asio::as_tuple(boost::asio::use_awaitable));
+
+        if (error == boost::asio::error::operation_aborted)
+        {
+            Error canceled;
+            canceled.code = error;
+            co_return canceled;
+        }
+        if (error)
+        {
+            co_return Error::make(Errc::ConnectionClosed, error.message(), error);
+        }
+        co_return Result<void>();
+    });
+}
+
+boost::asio::awaitable<void> Connection::writeMessages()
+{
+    // Detached, so it may resume after the connection is destroyed. The messages being written and
+    // the stream they are written to are held here until the write finishes.
+    const auto alive = m_alive;
+    const auto rateLimiter = m_rateLimiter;
+    std::vector<OutgoingMessage> batch;
+    while (!m_writeQueue.empty())
     {
-        boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor);
-        timer.expires_after(m_requestTimeout - duration);
-        co_await timer.async_wait(boost::asio::use_awaitable);
+        co_await rateLimiter->acquire();
+        if (!*alive)
+        {
+            co_return;
+        }
+        if (m_writeQueue.empty())
+        {
+            // Failed by stopWriting() in the meantime
+            break;
+        }
+
+        const auto websocket = m_websocket;
+        batch.push_back(takeFrontMessage());
+        boost::system::error_code error;
+        if (m_coalesceWrites && !m_writeQueue.empty())
+        {
+            co_await writeCoalesced(*websocket, batch, error);
+        }
+        else
+        {
+            const auto payload = boost::asio::buffer(batch.front().payload);
+            co_await std::visit(
+                [&payload, &error](auto &websocket) {
+                    return websocket.async_write(payload, boost::asio::redirect_error(boost::asio::use_awaitable, error));
+                },
+                *websocket);
+        }
+        if (!*alive)
+        {
+            co_return;
+        }
+
+        for (auto &message : batch)
+        {
+            completeMessage(message, error);
+        }
+        batch.clear();
+
+        if (error)
+        {
+            // The connection is broken, every message behind would only take a token to fail the same way
+            while (!m_writeQueue.empty())
+            {
+                auto message = takeFrontMessage();
+                completeMessage(message, error);
+            }
+        }
     }
+    m_writing = false;
+    m_writerIdle.cancel();
+}
 
-    try
+boost::asio::awaitable<void> Connection::stopWriting()
+{
+    // Reported as a closed connection, not as operation_aborted, which is the error of a canceled sender
+    while (!m_writeQueue.empty())
     {
-        const std::string message = boost::json::serialize(command);
-        co_await m_websocket.async_write(boost::asio::buffer(message), boost::asio::use_awaitable);
-        m_lastRequestTime = std::chrono::system_clock::now();
+        auto message = takeFrontMessage();
+        completeMessage(message, boost::asio::error::connection_aborted);
     }
-    catch (const boost::system::system_error &e)
+
+    if (m_writing)
     {
-        throw exception::ConnectionClosed(e.what());
+        boost::system::error_code ignored;
+        co_await m_writerIdle.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
     }
 }
 
-boost::asio::awaitable<boost::json::object> Connection::waitResponse()
+Connection::OutgoingMessage Connection::takeFrontMessage()
+{
+    OutgoingMessage message = std::move(m_writeQueue.front());
+    m_writeQueue.pop_front();
+    return message;
+}
+
+void Connection::completeMessage(OutgoingMessage &message, boost::system::error_code error)
+{
+    message.payload.clear();
+    m_spareBuffers.push_back(std::move(message.payload));
+
+    auto executor = boost::asio::get_associated_executor(message.handler);
+    boost::asio::post(executor, [handler = std::move(message.handler), error]() mutable {
+        boost::asio::get_associated_cancellation_slot(handler).clear();
+        std::move(handler)(error);
+    });
+}
+
+void Connection::cancelMessage(std::uint64_t id)
 {
-    boost::beast::flat_buffer buffer;
-    try
+    const auto queued = std::find_if(m_writeQueue.begin(), m_writeQueue.end(),
+                                     [id](const OutgoingMessage &message) { return message.id == id; });
+    if (queued == m_writeQueue.end())
     {
-        co_await m_websocket.async_read(buffer, boost::asio::use_awaitable);
-        auto dataString = boost::beast::buffers_to_string(buffer.data());
-        buffer.consume(buffer.size());
+        // Already taken by the writer
+        return;
+    }
 
-        boost::json::object jsonData = boost::json::parse(dataString).as_object();
+    OutgoingMessage message = std::move(*queued);
+    m_writeQueue.erase(queued);
+    completeMessage(message, boost::asio::error::operation_aborted);
+}
 
-        co_return jsonData;
+boost::asio::awaitable<void> Connection::writeCoalesced(Websocket &websocket, std::vector<OutgoingMessage> &batch,
+                                                        boost::system::error_code &error)
+{
+    const auto alive = m_alive;
+
+    // The WebSocket stream frames every message as usual, the frames are only held back
+    // below it and sent together by the flush
+    std::visit([](auto &websocket) { websocket.next_layer().cork(); }, websocket);
+
+    std::size_t batchBytes = 0;
+    while (true)
+    {
+        const auto payload = boost::asio::buffer(batch.back().payload);
+        batchBytes += payload.size();
+        co_await std::visit(
+            [&payload, &error](auto &websocket) {
+                return websocket.async_write(payload, boost::asio::redirect_error(boost::asio::use_awaitable, error));
+            },
+            websocket);
+
+        if (!*alive || error || m_writeQueue.empty() || batchBytes >= m_maxCoalescedBytes ||
+            !m_rateLimiter->tryAcquire())
+        {
+            break;
+        }
+        batch.push_back(takeFrontMessage());
     }
-    catch (const boost::system::system_error &e)
+
+    // Flushed also after a failure, so that the stream is not left corked
+    boost::system::error_code flushError;
+    co_await std::visit([&flushError](auto &websocket) { return websocket.next_layer().flush(flushError); },
+                        websocket);
+    if (!error)
     {
-        if (e.code() == boost::asio::error::eof)
+        error = flushError;
+    }
+}
+
+boost::asio::awaitable<boost::json::object> Connection::waitResponse()
+{
+    co_return internals::unwrap(co_await tryWaitResponse());
+}
+
+boost::asio::awaitable<Result<boost::json::object>> Connection::tryWaitResponse()
+{
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        // Drop whatever is left from the previous message, the capacity is kept
+        m_readBuffer.clear();
+        boost::system::error_code error;
+        co_await std::visit(
+            [this, &error](auto &websocket) {
+                return websocket.async_read(m_readBuffer, boost::asio::redirect_error(boost::asio::use_awaitable, error));
+            },
+            *m_websocket);
+
+        if (!error)
         {
-            throw exception::ConnectionClosed("Connection closed by remote host");
+            rearmQuickAck();
+
+            // flat_buffer keeps the frame contiguous, so it can be parsed in place
+            auto response = parseFrame(m_readBuffer.cdata(), error);
+            if (!error)
+            {
+                co_return std::move(response);
+            }
         }
-        else
+
+        if (error == boost::asio::error::eof)
         {
-            throw exception::ConnectionClosed(e.what());
+            co_return Error::make(Errc::ConnectionClosed, "Connection closed by remote host", error);
         }
+        co_return Error::make(Errc::ConnectionClosed, error.message(), error);
+    });
+}
+
+boost::json::object Connection::parseFrame(boost::asio::const_buffer frame, boost::system::error_code &error)
+{
+    // The DOM of a message is usually about twice the size of its text, reserving that
+    // up front lets most messages fit into the first block of the arena.
+    m_jsonParser.reset(boost::json::make_shared_resource<boost::json::monotonic_resource>(frame.size() * 2));
+    m_jsonParser.write(static_cast<const char *>(frame.data()), frame.size(), error);
+    if (!error)
+    {
+        m_jsonParser.finish(error);
     }
+    if (error)
+    {
+        return {};
+    }
+
+    boost::json::value jsonValue = m_jsonParser.release();
+    if (!jsonValue.is_object())
+    {
+        error = boost::json::error::not_object;
+        return {};
+    }
+    return std::move(jsonValue.get_object());
 }
 
-boost::asio::awaitable<void> Connection::startKeepAlive(boost::asio::cancellation_slot cancellationSlot)
+boost::asio::awaitable<void> Connection::startKeepAlive(std::shared_ptr<boost::asio::cancellation_signal> stop)
 {
+    // Pings the stream it was started for, held here so that a ping in progress during a reconnect
+    // finishes on it. May resume after the connection is destroyed, the signal is held here as well.
+    const auto alive = m_alive;
+    const auto websocket = m_websocket;
     const auto executor = co_await boost::asio::this_coro::executor;
     boost::asio::steady_timer pingTimer(executor);
-    const auto pingInterval = std::chrono::seconds(20);
-    bool canceled = true;
+    bool canceled = false;
+
+    auto isOpen = [&websocket]() {
+        return std::visit([](const auto &stream) { return stream.is_open(); }, *websocket);
+    };
 
-    cancellationSlot.assign([&](boost::asio::cancellation_type type) {
+    stop->slot().assign([&](boost::asio::cancellation_type type) {
         if (type == boost::asio::cancellation_type::all)
         {
             canceled = true;
@@ -171,27 +608,66 @@ boost::asio::awaitable<void> Connection::startKeepAlive(boost::asio::cancellatio
         }
     });
 
-    while (!canceled)
+    boost::system::error_code error;
+    while (!canceled && !error && isOpen())
     {
-        try
+        pingTimer.expires_after(m_keepAliveInterval);
+        co_await pingTimer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, error));
+        if (!*alive || canceled || error || !isOpen())
         {
-            pingTimer.expires_after(pingInterval);
-            co_await pingTimer.async_wait(boost::asio::use_awaitable);
-
-            if (m_websocket.is_open())
-            {
-                co_await m_websocket.async_ping({}, boost::asio::use_awaitable);
-            }
-            else
-            {
-                break;
-            }
+            break;
         }
-        catch (const boost::system::system_error &e)
+
+        const std::string payload = std::to_string(++m_pingSequence);
+        m_pingSentAt = std::chrono::steady_clock::now();
+        const boost::beast::websocket::ping_data pingData(payload.c_str());
+        co_await std::visit(
+            [&pingData, &error](auto &stream) {
+                return stream.async_ping(pingData, boost::asio::redirect_error(boost::asio::use_awaitable, error));
+            },
+            *websocket);
+        if (!*alive)
         {
-            throw exception::ConnectionClosed(e.what());
+            break;
         }
     }
+
+    // The handler refers to the locals of this coroutine
+    stop->slot().clear();
+}
+
+void Connection::stopKeepAlive()
+{
+    // Every keep-alive gets its own signal, so the one stopped here cannot clear the handler of the next
+    m_keepAliveStop->emit(boost::asio::cancellation_type::all);
+    m_keepAliveStop = std::make_shared<boost::asio::cancellation_signal>();
+}
+
+bool Connection::isOpen() const
+{
+    return std::visit([](const auto &websocket) { return websocket.is_open(); }, *m_websocket);
+}
+
+boost::beast::tcp_stream &Connection::tcpStream()
+{
+    return std::visit(
+        [](auto &websocket) -> boost::beast::tcp_stream & { return boost::beast::get_lowest_layer(websocket); },
+        *m_websocket);
+}
+
+void Connection::onPong(boost::beast::string_view payload)
+{
+    if (m_pingSentAt && payload == std::to_string(m_pingSequence))
+    {
+        m_rttHistogram->record(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - *m_pingSentAt));
+        m_pingSentAt.reset();
+    }
+}
+
+std::shared_ptr<const LatencyHistogram> Connection::getRttHistogram() const
+{
+    return m_rttHistogram;
 }
 
 } // namespace internals
@@ -8,11 +8,22 @@
  * establishing and managing connections, making requests, and handling responses.
  */
 
+#include "CommandSerializer.hpp"
+#include "ConnectionOptions.hpp"
 #include "IConnection.hpp"
+#include "Strand.hpp"
+#include "WriteCoalescingStream.hpp"
+#include <boost/asio/any_completion_handler.hpp>
 #include <boost/beast.hpp>
 #include <boost/beast/websocket/ssl.hpp>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
 #include <string>
+#include <variant>
+#include <vector>
 
 namespace xapi
 {
@@ -23,8 +34,10 @@ namespace internals
  * @class Connection
  * @brief Manages connection and communication with a server using secure WebSocket.
  *
- * The Connection class encapsulates the functionality for establishing an SSL connection,
- * sending requests, and receiving responses.
+ * The Connection class encapsulates the functionality for establishing an SSL connection (or a
+ * plain one for `ws://` URLs),
+ * sending requests, and receiving responses. All its handlers run on a strand, so the
+ * connection may be used from an io_context run by several threads.
  */
 class Connection : public IConnection
 {
@@ -34,20 +47,42 @@ class Connection : public IConnection
     Connection(const Connection &other) = delete;
     Connection &operator=(const Connection &other) = delete;
 
-    Connection(Connection &&other) noexcept;
-    // Move assignment operator is not supported because of boost::beast::websocket::stream
+    // Not movable, the WebSocket control callback and the detached writer and keep-alive coroutines refer to this
+    Connection(Connection &&other) = delete;
     Connection &operator=(Connection &&other) = delete;
 
     /**
      * @brief Constructs a new Connection object.
      * @param ioContext The IO context for asynchronous operations.
+     * @param options The connection options.
      */
-    explicit Connection(boost::asio::io_context &ioContext);
+    explicit Connection(boost::asio::io_context &ioContext, const ConnectionOptions &options = ConnectionOptions());
 
+    /**
+     * @brief Constructs a new Connection object bound to an existing strand.
+     * @param strand The strand to run the handlers of the connection on, e.g. shared with its owner.
+     * @param options The connection options.
+     */
+    explicit Connection(const Strand &strand, const ConnectionOptions &options = ConnectionOptions());
+
+    /**
+     * @brief Destroys the Connection object.
+     *
+     * May run on any thread. The detached coroutines of the connection see it gone at their next
+     * step, and the keep-alive is stopped and the stream closed on the strand. If the io_context
+     * is stopped, nothing runs on the strand and the stream is closed at once. Calls of the
+     * connection itself must have completed.
+     */
     virtual ~Connection() override;
 
     /**
-     * @brief Asynchronously establishes secure WebSocket connection to the server.
+     * @brief Asynchronously establishes WebSocket connection to the server.
+     *
+     * `wss://` URLs connect over TLS, `ws://` URLs over plain TCP, e.g. to a local stand-in server.
+     *
+     * May be called again after the connection failed or was closed, to reconnect. Must not be
+     * called while messages are being read or written.
+     *
      * @param url The URL to connect to.
      * @return An awaitable void.
      * @throw xapi::exception::ConnectionClosed if the connection fails.
@@ -68,52 +103,317 @@ class Connection : public IConnection
      */
     boost::asio::awaitable<void> makeRequest(const boost::json::object &command) override;
 
+    /**
+     * @brief Sends an already serialized command to the server.
+     *
+     * The message is copied into the outgoing queue when the returned awaitable is awaited,
+     * so the caller may reuse its buffer right away. Messages are written in the order they were
+     * queued, which makes it safe for several coroutines to send concurrently. With
+     * ConnectionOptions::coalesceWrites, messages queued together are sent in one write.
+     *
+     * @param message The serialized command.
+     * @return An awaitable void, completed once the message is written.
+     * @throw xapi::exception::ConnectionClosed if the request fails.
+     */
+    boost::asio::awaitable<void> sendMessage(std::string_view message) override;
+
     /**
      * @brief Waits for a response from the server.
+     *
+     * The response is built in a monotonic arena owned by the returned object,
+     * so the whole message is freed at once when the object is destroyed.
+     *
      * @return An awaitable boost::json::object with response from the server.
      * @throw xapi::exception::ConnectionClosed if the response fails.
      */
     boost::asio::awaitable<boost::json::object> waitResponse() override;
 
+    /**
+     * @brief Gets the histogram of the keep-alive ping round trips.
+     *
+     * A round trip ends when the pong is read, so it is accurate only while the connection is being
+     * read, e.g. a stream being listened to or a client with requests in flight. Pongs that arrive
+     * after the next ping was sent are not recorded.
+     *
+     * @return The histogram, thread safe to read.
+     */
+    std::shared_ptr<const LatencyHistogram> getRttHistogram() const override;
+
+    /**
+     * @brief Establishes the connection like connect(), without throwing on failure.
+     * @param url The URL to connect to.
+     * @return An awaitable Result, Errc::ConnectionClosed with the lower level error as cause on failure.
+     */
+    boost::asio::awaitable<Result<void>> tryConnect(const boost::url &url) override;
+
+    /**
+     * @brief Sends an already serialized command like sendMessage(), without throwing on failure.
+     *
+     * Canceled while the command still waits in the queue, e.g. by withDeadline(), the command is
+     * dropped and the result is boost::asio::error::operation_aborted.
+     *
+     * @param message The serialized command.
+     * @return An awaitable Result, Errc::ConnectionClosed with the lower level error as cause on failure.
+     */
+    boost::asio::awaitable<Result<void>> trySendMessage(std::string_view message) override;
+
+    /**
+     * @brief Waits for a response like waitResponse(), without throwing on failure.
+     * @return An awaitable Result with the response, Errc::ConnectionClosed with the lower level error
+     * as cause on failure.
+     */
+    boost::asio::awaitable<Result<boost::json::object>> tryWaitResponse() override;
+
   private:
     // The IO context for asynchronous operations.
     boost::asio::io_context &m_ioContext;
 
+    // Strand all handlers of the connection run on.
+    Strand m_strand;
+
+    /**
+     * @brief Resolves the host, through the resolver cache if there is one.
+     * @param host The host name.
+     * @param port The port.
+     * @param error Set to the error if the host cannot be resolved.
+     * @return An awaitable with the resolved endpoints.
+     */
+    boost::asio::awaitable<ResolverCache::Endpoints> resolve(const std::string &host, const std::string &port,
+                                                             boost::system::error_code &error);
+
+    /**
+     * @brief Establishes a TCP connection, racing the resolved endpoints.
+     * @param host The host name.
+     * @param port The port.
+     * @param error Set to the error if no endpoint can be reached.
+     * @return An awaitable void.
+     */
+    boost::asio::awaitable<void> establishTcpConnection(const std::string &host, const std::string &port,
+                                                        boost::system::error_code &error);
+
+    /**
+     * @brief Applies the socket options to the connected TCP socket.
+     * @param error Set to the error if an option cannot be set.
+     */
+    void applySocketOptions(boost::system::error_code &error);
+
+    /**
+     * @brief Sets TCP_QUICKACK again if enabled, the kernel clears it after acknowledging.
+     */
+    void rearmQuickAck();
+
     /**
-     * @brief Establishes an SSL connection asynchronously.
-     * @param results The resolved endpoints to attempt to connect to.
+     * @brief Establishes an SSL connection asynchronously over the connected TCP stream.
      * @param host The host name.
+     * @param port The port, with the host and the SSL context the key of the cached TLS session.
+     * @param error Set to the error if the SSL connection fails.
      * @return An awaitable void.
-     * @throw xapi::exception::ConnectionClosed if the SSL connection fails.
      */
-    boost::asio::awaitable<void> establishSSLConnection(const boost::asio::ip::tcp::resolver::results_type &results,
-                                                        const char *host);
+    boost::asio::awaitable<void> establishSSLConnection(const std::string &host, const std::string &port,
+                                                        boost::system::error_code &error);
 
     /**
      * @brief Starts the keep-alive coroutine.
-     * @param cancellationSlot The cancellation slot for stopping the coroutine.
+     *
+     * Sends a ping every keep-alive interval, with a sequence number as payload so that onPong()
+     * can measure its round trip. Stops when canceled, when the connection is closed or when a
+     * ping fails.
+     *
+     * @param stop The signal stopping the coroutine, used by this keep-alive only.
      * @return An awaitable void.
-     * @throw xapi::exception::ConnectionClosed if the ping fails.
      */
-    boost::asio::awaitable<void> startKeepAlive(boost::asio::cancellation_slot cancellationSlot);
+    boost::asio::awaitable<void> startKeepAlive(std::shared_ptr<boost::asio::cancellation_signal> stop);
+
+    /**
+     * @brief Stops the keep-alive of the current stream and prepares the signal of the next one.
+     */
+    void stopKeepAlive();
+
+    /**
+     * @brief Checks if the WebSocket stream is open.
+     * @return True if the stream is open.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Gets the TCP stream under the WebSocket stream.
+     * @return The TCP stream.
+     */
+    boost::beast::tcp_stream &tcpStream();
+
+    /**
+     * @brief Records the round trip of the outstanding ping if the pong answers it.
+     * @param payload The payload of the pong.
+     */
+    void onPong(boost::beast::string_view payload);
+
+    /**
+     * @brief Parses a received frame into an object built in its own monotonic arena.
+     *
+     * The arena is owned by the returned object through its storage pointer, so the whole
+     * DOM is released at once when the caller drops the result.
+     *
+     * @param frame The received frame.
+     * @param error Set to the error if the frame is not a valid JSON object.
+     * @return The parsed object.
+     */
+    boost::json::object parseFrame(boost::asio::const_buffer frame, boost::system::error_code &error);
+
+    using TlsWebsocket =
+        boost::beast::websocket::stream<WriteCoalescingStream<boost::asio::ssl::stream<boost::beast::tcp_stream>>>;
+    using PlainWebsocket = boost::beast::websocket::stream<WriteCoalescingStream<boost::beast::tcp_stream>>;
+    using Websocket = std::variant<TlsWebsocket, PlainWebsocket>;
+
+    // Handler completing a queued message once it is written, or with an error.
+    using WriteHandler = boost::asio::any_completion_handler<void(boost::system::error_code)>;
+
+    /**
+     * A message waiting in the outgoing queue.
+     */
+    struct OutgoingMessage
+    {
+        std::string payload;
+        WriteHandler handler;
+
+        // Identifies the message to its cancellation handler.
+        std::uint64_t id = 0;
+    };
+
+    /**
+     * @brief Writes the queued messages until the queue is empty.
+     *
+     * If a write fails, the messages still queued fail with the same error and the writer stops.
+     * The writer is detached and holds the messages it writes and the stream it writes them to,
+     * so it may outlive the connection, in which case it stops without touching it.
+     *
+     * @return An awaitable void.
+     */
+    boost::asio::awaitable<void> writeMessages();
+
+    /**
+     * @brief Fails the queued messages as closed and waits until the writer stops.
+     *
+     * The socket of the old stream must be closed first, so that a write in progress fails.
+     *
+     * Called before the stream is replaced, so that nothing sent for the old stream reaches the new one.
+     *
+     * @return An awaitable void.
+     */
+    boost::asio::awaitable<void> stopWriting();
+
+    /**
+     * @brief Removes the front message from the queue.
+     * @return The message.
+     */
+    OutgoingMessage takeFrontMessage();
+
+    /**
+     * @brief Completes the sender of a message taken from the queue and keeps its buffer for reuse.
+     * @param message The message.
+     * @param error The result of the write, empty on success.
+     */
+    void completeMessage(OutgoingMessage &message, boost::system::error_code error);
+
+    /**
+     * @brief Drops a canceled message from the queue and completes it with operation_aborted.
+     *
+     * A message the writer already took is written and completes as usual.
+     *
+     * @param id The id of the message.
+     */
+    void cancelMessage(std::uint64_t id);
+
+    /**
+     * @brief Writes the batch and the following queued messages as one batch of WebSocket messages.
+     *
+     * The first message of the batch must already have its rate limiter token. The following queued
+     * messages join the batch while tokens are available without waiting, up to m_maxCoalescedBytes.
+     *
+     * @param websocket The stream to write to.
+     * @param batch The messages taken from the queue, more are appended to it.
+     * @param error Set to the error if the write fails.
+     * @return An awaitable void.
+     */
+    boost::asio::awaitable<void> writeCoalesced(Websocket &websocket, std::vector<OutgoingMessage> &batch,
+                                                boost::system::error_code &error);
+
+    // SSL context, stores certificates. Shared with other connections.
+    std::shared_ptr<boost::asio::ssl::context> m_sslContext;
+
+    // Upper bound of the payload gathered into one coalesced write.
+    static constexpr std::size_t m_maxCoalescedBytes = 64 * 1024;
+
+    // The WebSocket stream, over TLS for `wss://` URLs. Replaced by a fresh one on every connect,
+    // shared with the writer so that a write in progress finishes on the stream it started on.
+    std::shared_ptr<Websocket> m_websocket;
+
+    // Cleared by the destructor, possibly on another thread. Detached coroutines and handlers hold
+    // a copy and stop once it is false.
+    std::shared_ptr<std::atomic<bool>> m_alive;
+
+    // Receive buffer, reused between messages so its capacity settles at the largest frame seen.
+    boost::beast::flat_buffer m_readBuffer;
+
+    // JSON parser, reused between messages so its internal stacks are allocated once.
+    boost::json::stream_parser m_jsonParser;
+
+    // Serializer for outgoing commands.
+    CommandSerializer m_commandSerializer;
+
+    // Send buffer, reused between commands so its capacity settles at the largest command sent.
+    std::string m_writeBuffer;
+
+    // Messages waiting to be written, in the order they were sent.
+    std::deque<OutgoingMessage> m_writeQueue;
+
+    // Payload buffers of written messages, reused for the next queued ones.
+    std::vector<std::string> m_spareBuffers;
+
+    // id of the next queued message.
+    std::uint64_t m_nextMessageId;
+
+    // Flag to indicate if the coroutine writing the queued messages is running.
+    bool m_writing;
+
+    // Never expires, canceled by the writer when it stops to wake stopWriting().
+    boost::asio::steady_timer m_writerIdle;
+
+    // Flag to indicate if messages queued together are sent in one write.
+    const bool m_coalesceWrites;
+
+    // Signal stopping the keep-alive of the current stream. Replaced for every keep-alive, which
+    // holds its own so that the slot outlives the connection.
+    std::shared_ptr<boost::asio::cancellation_signal> m_keepAliveStop;
+
+    // Interval of the keep-alive pings.
+    const std::chrono::milliseconds m_keepAliveInterval;
+
+    // Round trips of the keep-alive pings.
+    std::shared_ptr<LatencyHistogram> m_rttHistogram;
+
+    // Sequence number of the last ping, sent as its payload so that the pong can be matched.
+    std::uint64_t m_pingSequence;
+
+    // Time the last ping was sent, empty once its pong arrived.
+    std::optional<std::chrono::steady_clock::time_point> m_pingSentAt;
 
-    // SSL context, stores certificates.
-    boost::asio::ssl::context m_sslContext;
+    // Limiter for outgoing requests, possibly shared with other connections.
+    std::shared_ptr<IRateLimiter> m_rateLimiter;
 
-    // The WebSocket stream.
-    boost::beast::websocket::stream<boost::asio::ssl::stream<boost::beast::tcp_stream>> m_websocket;
+    // Cache of TLS sessions to resume, none if every handshake is a full one.
+    std::shared_ptr<TlsSessionCache> m_tlsSessionCache;
 
-    // Cancellation signal for stopping keepAlive coroutine
-    boost::asio::cancellation_signal m_cancellationSignal;
+    // Cache of resolved endpoints, none if every connect resolves the host.
+    std::shared_ptr<ResolverCache> m_resolverCache;
 
-    // Time of the last request.
-    std::chrono::time_point<std::chrono::system_clock> m_lastRequestTime;
+    // Head start of a connection attempt before the next endpoint is tried in parallel.
+    const std::chrono::milliseconds m_connectAttemptDelay;
 
-    // Timeout for requests.
-    const std::chrono::milliseconds m_requestTimeout;
+    // Options applied to the TCP socket once it is connected.
+    const SocketOptions m_socketOptions;
 
-    // Default port for WebSocket connections.
-    const std::string m_websocketDefaultPort;
+    // permessage-deflate offered in the WebSocket handshake.
+    const boost::beast::websocket::permessage_deflate m_deflateOptions;
 };
 
 } // namespace internals
@@ -0,0 +1,94 @@
+#pragma once
+
+/**
+ * @file ConnectionOptions.hpp
+ * @brief Defines the options applied to the connections of the clients.
+ */
+
+#include "CompressionOptions.hpp"
+#include "Endpoint.hpp"
+#include "RateLimiter.hpp"
+#include "ReconnectPolicy.hpp"
+#include "ResolverCache.hpp"
+#include "SocketOptions.hpp"
+#include "TlsSessionCache.hpp"
+#include <boost/asio/ssl/context.hpp>
+#include <chrono>
+#include <memory>
+
+namespace xapi
+{
+
+/**
+ * @brief Options applied to the connections of XStationClient and XStationClientStream.
+ */
+struct ConnectionOptions
+{
+    /**
+     * Address of the servers the client and its streams connect to. xStation5 by default.
+     */
+    Endpoint endpoint;
+
+    /**
+     * Limiter for outgoing requests. Connections constructed with the same limiter share
+     * its budget, e.g. the main and stream connections of one account. If not set, every
+     * connection gets its own RateLimiter with the xAPI limit of one request per 200 ms.
+     */
+    std::shared_ptr<IRateLimiter> rateLimiter;
+
+    /**
+     * Cache of TLS sessions, resumed by later connections to the same host instead of a full
+     * handshake. By default all connections share TlsSessionCache::shared(). Set to nullptr to
+     * perform a full handshake on every connection.
+     */
+    std::shared_ptr<TlsSessionCache> tlsSessionCache = TlsSessionCache::shared();
+
+    /**
+     * Client SSL context, e.g. with a certificate store and verification set up once for all
+     * connections. If not set, all connections share one TLS 1.3 client context created on first use.
+     */
+    std::shared_ptr<boost::asio::ssl::context> sslContext;
+
+    /**
+     * Cache of resolved endpoints, may be shared by all connections. If not set, the host is
+     * resolved on every connect.
+     */
+    std::shared_ptr<ResolverCache> resolverCache;
+
+    /**
+     * Time a connection attempt to one endpoint gets before the next endpoint is tried in
+     * parallel. The first established connection wins, so a dead endpoint costs at most this delay.
+     */
+    std::chrono::milliseconds connectAttemptDelay = std::chrono::milliseconds(250);
+
+    /**
+     * Interval of the keep-alive pings. Every ping measures the round trip to the server,
+     * see XStationClient::getRttHistogram().
+     */
+    std::chrono::milliseconds keepAliveInterval = std::chrono::seconds(20);
+
+    /**
+     * Options applied to the TCP socket once it is connected. Nagle's algorithm is disabled by default.
+     */
+    SocketOptions socket;
+
+    /**
+     * Options of the permessage-deflate extension. Disabled by default.
+     */
+    CompressionOptions compression;
+
+    /**
+     * Sends the messages queued in the same event loop tick, e.g. a burst of subscriptions sent
+     * concurrently, with one write instead of one per message. Each message is still a WebSocket
+     * message of its own and takes its own rate limiter token; messages without an available token
+     * wait for the next write. Disabled by default.
+     */
+    bool coalesceWrites = false;
+
+    /**
+     * Reconnect policy of the streams. Disabled by default.
+     */
+    ReconnectPolicy reconnect;
+};
+
+} // namespace xapi
@@ -0,0 +1,82 @@
+#pragma once
+
+/**
+ * @file Deadline.hpp
+ * @brief Defines the withDeadline function for bounding the time of asynchronous operations.
+ */
+
+#include "Error.hpp"
+#include "Exceptions.hpp"
+#include <boost/asio.hpp>
+#include <boost/asio/experimental/awaitable_operators.hpp>
+#include <chrono>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+namespace xapi
+{
+
+/**
+ * @brief Runs an operation with a deadline.
+ *
+ * When the timeout expires first, the operation is canceled through its cancellation slot. A
+ * request of XStationClient canceled this way stops waiting for its response and drops the
+ * response when it arrives later, e.g.
+ *
+ *     auto marginLevel = co_await xapi::withDeadline(client.getMarginLevel(), std::chrono::milliseconds(50));
+ *
+ * @param operation The operation to run.
+ * @param timeout Time the operation may take.
+ * @return An awaitable with the result of the operation.
+ * @throw xapi::exception::RequestTimeout if the timeout expires first.
+ */
+template <typename T>
+boost::asio::awaitable<T> withDeadline(boost::asio::awaitable<T> operation, std::chrono::steady_clock::duration timeout)
+{
+    using namespace boost::asio::experimental::awaitable_operators;
+
+    boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, timeout);
+    auto result = co_await (std::move(operation) || timer.async_wait(boost::asio::use_awaitable));
+    if (result.index() == 1)
+    {
+        const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count();
+        throw exception::RequestTimeout("No response within " + std::to_string(milliseconds) + " ms");
+    }
+
+    if constexpr (!std::is_void_v<T>)
+    {
+        co_return std::get<0>(std::move(result));
+    }
+}
+
+/**
+ * @brief Runs an operation of the non-throwing API with a deadline.
+ *
+ * Same as the throwing overload, but a timeout is returned as Errc::RequestTimeout instead of
+ * thrown, e.g.
+ *
+ *     auto marginLevel = co_await xapi::withDeadline(client.tryGetMarginLevel(), std::chrono::milliseconds(50));
+ *
+ * @param operation The operation to run.
+ * @param timeout Time the operation may take.
+ * @return An awaitable with the Result of the operation, or Errc::RequestTimeout.
+ */
+template <typename T>
+boost::asio::awaitable<Result<T>> withDeadline(boost::asio::awaitable<Result<T>> operation,
+                                               std::chrono::steady_clock::duration timeout)
+{
+    using namespace boost::asio::experimental::awaitable_operators;
+
+    boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor, timeout);
+    auto result =
+        co_await (std::move(operation) || timer.async_wait(boost::asio::as_tuple(boost::asio::use_awaitable)));
+    if (result.index() == 1)
+    {
+        const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count();
+        co_return Error::make(Errc::RequestTimeout, "No response within " + std::to_string(milliseconds) + " ms");
+    }
+    co_return std::get<0>(std::move(result));
+}
+
+} // namespace xapi
@@ -0,0 +1,22 @@
+#include "Endpoint.hpp"
+
+namespace xapi
+{
+
+boost::url Endpoint::url(std::string_view path) const
+{
+    boost::url url;
+    url.set_scheme_id(tls ? boost::urls::scheme::wss : boost::urls::scheme::ws);
+    url.set_host(host);
+    if (port != 0)
+    {
+        url.set_port_number(port);
+    }
+
+    std::string fullPath = pathPrefix;
+    fullPath.append(path);
+    url.set_path(fullPath);
+    return url;
+}
+
+} // namespace xapi
@@ -0,0 +1,54 @@
+#pragma once
+
+/**
+ * @file Endpoint.hpp
+ * @brief Defines the Endpoint structure with the address of the xAPI servers.
+ */
+
+#include <boost/url.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace xapi
+{
+
+/**
+ * @brief Address of the xAPI servers.
+ *
+ * The client connects to `<pathPrefix><accountType>` and its streams to
+ * `<pathPrefix><accountType>Stream`. The default is the xStation5 server, another endpoint is
+ * useful e.g. to run the client against a local stand-in server.
+ */
+struct Endpoint
+{
+    /**
+     * Flag to connect over TLS (`wss://`). If false, the connection is plain WebSocket (`ws://`),
+     * which is meant for local servers only.
+     */
+    bool tls = true;
+
+    /**
+     * Host name or IP address of the server.
+     */
+    std::string host = "ws.xtb.com";
+
+    /**
+     * Port of the server, 0 for the default port of the scheme.
+     */
+    std::uint16_t port = 0;
+
+    /**
+     * Path the account type is appended to.
+     */
+    std::string pathPrefix = "/";
+
+    /**
+     * @brief Builds the URL of a server path.
+     * @param path The path appended to the prefix, e.g. `demo` or `demoStream`.
+     * @return The URL.
+     */
+    boost::url url(std::string_view path) const;
+};
+
+} // namespace xapi
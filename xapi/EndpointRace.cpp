@@ -0,0 +1,145 @@
+#include "EndpointRace.hpp"
+#include <algorithm>
+#include <memory>
+#include <optional>
+
+namespace xapi
+{
+namespace internals
+{
+
+namespace
+{
+
+// State shared by the racing attempts, all of them run on the same executor.
+struct RaceState
+{
+    explicit RaceState(const boost::asio::any_io_executor &executor) : wakeUp(executor)
+    {
+    }
+
+    // Canceled whenever an attempt completes, to wake up the race.
+    boost::asio::steady_timer wakeUp;
+
+    std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>> attempts;
+    std::optional<boost::asio::ip::tcp::socket> winner;
+    std::size_t pendingAttempts = 0;
+    boost::system::error_code lastError = boost::asio::error::host_not_found;
+};
+
+boost::asio::awaitable<void> attemptConnect(std::shared_ptr<RaceState> state, std::size_t index,
+                                            boost::asio::ip::tcp::endpoint endpoint)
+{
+    auto &socket = *state->attempts[index];
+    boost::system::error_code error;
+    co_await socket.async_connect(endpoint, boost::asio::redirect_error(boost::asio::use_awaitable, error));
+    --state->pendingAttempts;
+
+    if (!error && !state->winner)
+    {
+        state->winner.emplace(std::move(socket));
+        for (auto &attempt : state->attempts)
+        {
+            // Cancels the attempts still in progress
+            boost::system::error_code ignored;
+            attempt->close(ignored);
+        }
+    }
+    else if (error)
+    {
+        state->lastError = error;
+    }
+    state->wakeUp.cancel();
+}
+
+boost::asio::awaitable<void> waitForAttempts(RaceState &state, boost::asio::steady_timer::time_point deadline)
+{
+    boost::system::error_code ignored;
+    state.wakeUp.expires_at(deadline);
+    co_await state.wakeUp.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
+}
+
+} // namespace
+
+std::vector<boost::asio::ip::tcp::endpoint> interleaveAddressFamilies(
+    const std::vector<boost::asio::ip::tcp::endpoint> &endpoints)
+{
+    if (endpoints.empty())
+    {
+        return {};
+    }
+
+    const bool preferV6 = endpoints.front().address().is_v6();
+    std::vector<boost::asio::ip::tcp::endpoint> preferred;
+    std::vector<boost::asio::ip::tcp::endpoint> other;
+    for (const auto &endpoint : endpoints)
+    {
+        (endpoint.address().is_v6() == preferV6 ? preferred : other).push_back(endpoint);
+    }
+
+    std::vector<boost::asio::ip::tcp::endpoint> ordered;
+    ordered.reserve(endpoints.size());
+    for (std::size_t i = 0; i < std::max(preferred.size(), other.size()); ++i)
+    {
+        if (i < preferred.size())
+        {
+            ordered.push_back(preferred[i]);
+        }
+        if (i < other.size())
+        {
+            ordered.push_back(other[i]);
+        }
+    }
+    return ordered;
+}
+
+boost::asio::awaitable<boost::asio::ip::tcp::socket> raceConnect(
+    boost::asio::any_io_executor executor, const std::vector<boost::asio::ip::tcp::endpoint> &endpoints,
+    std::chrono::steady_clock::duration attemptDelay)
+{
+    boost::system::error_code error;
+    auto socket = co_await raceConnect(executor, endpoints, attemptDelay, error);
+    if (error)
+    {
+        throw boost::system::system_error(error);
+    }
+    co_return socket;
+}
+
+boost::asio::awaitable<boost::asio::ip::tcp::socket> raceConnect(
+    boost::asio::any_io_executor executor, const std::vector<boost::asio::ip::tcp::endpoint> &endpoints,
+    std::chrono::steady_clock::duration attemptDelay, boost::system::error_code &error)
+{
+    auto state = std::make_shared<RaceState>(executor);
+
+    for (const auto &endpoint : interleaveAddressFamilies(endpoints))
+    {
+        state->attempts.push_back(std::make_unique<boost::asio::ip::tcp::socket>(executor));
+        ++state->pendingAttempts;
+        boost::asio::co_spawn(executor, attemptConnect(state, state->attempts.size() - 1, endpoint),
+                              boost::asio::detached);
+
+        // Head start for the new attempt, cut short when any attempt completes
+        co_await waitForAttempts(*state, boost::asio::steady_timer::clock_type::now() + attemptDelay);
+        if (state->winner)
+        {
+            break;
+        }
+    }
+
+    while (!state->winner && state->pendingAttempts > 0)
+    {
+        co_await waitForAttempts(*state, boost::asio::steady_timer::time_point::max());
+    }
+
+    if (!state->winner)
+    {
+        error = state->lastError;
+        co_return boost::asio::ip::tcp::socket(executor);
+    }
+    error = {};
+    co_return std::move(*state->winner);
+}
+
+} // namespace internals
+} // namespace xapi
@@ -0,0 +1,61 @@
+#pragma once
+
+/**
+ * @file EndpointRace.hpp
+ * @brief Defines the functions for racing connection attempts to resolved endpoints.
+ *
+ * The attempts are staggered in the style of Happy Eyeballs (RFC 8305): a new attempt starts when
+ * the previous one fails or after a short delay, and the first established connection wins.
+ */
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <vector>
+
+namespace xapi
+{
+namespace internals
+{
+
+/**
+ * @brief Orders endpoints so that the address families alternate, starting with the first one.
+ * @param endpoints The endpoints in the order returned by the resolver.
+ * @return The reordered endpoints.
+ */
+std::vector<boost::asio::ip::tcp::endpoint> interleaveAddressFamilies(
+    const std::vector<boost::asio::ip::tcp::endpoint> &endpoints);
+
+/**
+ * @brief Connects to the first endpoint that accepts the connection.
+ *
+ * Attempts start in the order of interleaveAddressFamilies(). The next attempt starts as soon as
+ * the previous one fails, or after attemptDelay if it is still pending, so a single dead endpoint
+ * costs at most one delay. When one attempt succeeds, the others are canceled.
+ *
+ * @param executor The executor to run the attempts on. Must not run handlers concurrently, e.g. a strand.
+ * @param endpoints The endpoints to connect to.
+ * @param attemptDelay Time to wait for a pending attempt before starting the next one.
+ * @return An awaitable with the connected socket.
+ * @throw boost::system::system_error with the error of the last attempt if all attempts fail.
+ */
+boost::asio::awaitable<boost::asio::ip::tcp::socket> raceConnect(
+    boost::asio::any_io_executor executor, const std::vector<boost::asio::ip::tcp::endpoint> &endpoints,
+    std::chrono::steady_clock::duration attemptDelay);
+
+/**
+ * @brief Connects to the first endpoint that accepts the connection, without throwing.
+ *
+ * Same as the throwing overload, but reports the failure of all attempts through error.
+ *
+ * @param executor The executor to run the attempts on. Must not run handlers concurrently, e.g. a strand.
+ * @param endpoints The endpoints to connect to.
+ * @param attemptDelay Time to wait for a pending attempt before starting the next one.
+ * @param error Set to the error of the last attempt if all attempts fail.
+ * @return An awaitable with the connected socket, or a closed one on error.
+ */
+boost::asio::awaitable<boost::asio::ip::tcp::socket> raceConnect(
+    boost::asio::any_io_executor executor, const std::vector<boost::asio::ip::tcp::endpoint> &endpoints,
+    std::chrono::steady_clock::duration attemptDelay, boost::system::error_code &error);
+
+} // namespace internals
+} // namespace xapi
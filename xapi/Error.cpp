@@ -0,0 +1,84 @@
+#include "Error.hpp"
+#include "Exceptions.hpp"
+#include <boost/system/system_error.hpp>
+
+namespace xapi
+{
+
+namespace
+{
+
+class ErrorCategory final : public boost::system::error_category
+{
+  public:
+    const char *name() const noexcept override
+    {
+        return "xapi";
+    }
+
+    std::string message(int value) const override
+    {
+        switch (static_cast<Errc>(value))
+        {
+        case Errc::ConnectionClosed:
+            return "Connection closed";
+        case Errc::RequestTimeout:
+            return "Request timed out";
+        case Errc::RequestRejected:
+            return "Request rejected by the server";
+        case Errc::LoginFailed:
+            return "Login failed";
+        }
+        return "Unknown error";
+    }
+};
+
+} // namespace
+
+const boost::system::error_category &errorCategory() noexcept
+{
+    static const ErrorCategory category;
+    return category;
+}
+
+boost::system::error_code make_error_code(Errc errc) noexcept
+{
+    return boost::system::error_code(static_cast<int>(errc), errorCategory());
+}
+
+Error Error::make(Errc errc, std::string description, boost::system::error_code cause)
+{
+    Error error;
+    error.code = errc;
+    error.cause = cause;
+    error.description = std::move(description);
+    return error;
+}
+
+std::string Error::message() const
+{
+    return description.empty() ? code.message() : description;
+}
+
+namespace internals
+{
+
+void throwError(const Error &error)
+{
+    if (error.code == Errc::ConnectionClosed)
+    {
+        throw exception::ConnectionClosed(error.message());
+    }
+    if (error.code == Errc::RequestTimeout)
+    {
+        throw exception::RequestTimeout(error.message());
+    }
+    if (error.code == Errc::LoginFailed)
+    {
+        throw exception::LoginFailed(error.message());
+    }
+    throw boost::system::system_error(error.code, error.description);
+}
+
+} // namespace internals
+} // namespace xapi
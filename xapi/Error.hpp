@@ -0,0 +1,278 @@
+#pragma once
+
+/**
+ * @file Error.hpp
+ * @brief Defines the error values returned by the non-throwing API.
+ *
+ * This file contains the error codes of the XAPI, the Error type describing a failure and the
+ * Result type returned by the `try` variants of the client, stream and connection methods.
+ */
+
+#include <boost/system/error_code.hpp>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace xapi
+{
+
+/**
+ * @brief Error codes of the XAPI, in the category returned by errorCategory().
+ */
+enum class Errc
+{
+    // The connection failed, was closed or a message could not be read or written.
+    ConnectionClosed = 1,
+
+    // No response arrived before the deadline of the request.
+    RequestTimeout,
+
+    // The server answered with `"status": false`, see Error::serverCode.
+    RequestRejected,
+
+    // The login was refused or the account settings are invalid.
+    LoginFailed
+};
+
+/**
+ * @brief Gets the category of the XAPI error codes.
+ * @return The category, a single instance for the whole process.
+ */
+const boost::system::error_category &errorCategory() noexcept;
+
+/**
+ * @brief Makes an error code of the XAPI category, found by ADL for `boost::system::error_code ec = Errc::...`.
+ * @param errc The XAPI error code.
+ * @return The error code.
+ */
+boost::system::error_code make_error_code(Errc errc) noexcept;
+
+/**
+ * @brief Failure of an operation of the non-throwing API.
+ */
+struct Error
+{
+    /**
+     * What failed, an Errc, or boost::asio::error::operation_aborted if the operation was canceled.
+     */
+    boost::system::error_code code;
+
+    /**
+     * Lower level error behind a closed connection, e.g. boost::asio::error::eof, if known.
+     */
+    boost::system::error_code cause;
+
+    /**
+     * The `errorCode` of a request rejected by the server, e.g. `"BE005"`.
+     */
+    std::string serverCode;
+
+    /**
+     * Human readable description, the `errorDescr` of a rejected request.
+     */
+    std::string description;
+
+    /**
+     * @brief Makes an error of the XAPI category.
+     * @param errc The XAPI error code.
+     * @param description The description of the error.
+     * @param cause The lower level error, if any.
+     * @return The error.
+     */
+    static Error make(Errc errc, std::string description, boost::system::error_code cause = {});
+
+    /**
+     * @brief Gets the description, or the message of the code if there is none.
+     * @return The message.
+     */
+    std::string message() const;
+};
+
+namespace internals
+{
+
+/**
+ * @brief Throws the exception the throwing API reports the error with.
+ *
+ * Errc::ConnectionClosed throws xapi::exception::ConnectionClosed, Errc::RequestTimeout throws
+ * xapi::exception::RequestTimeout, Errc::LoginFailed throws xapi::exception::LoginFailed and other
+ * codes, e.g. a cancellation, throw boost::system::system_error.
+ *
+ * @param error The error.
+ */
+[[noreturn]] void throwError(const Error &error);
+
+} // namespace internals
+
+/**
+ * @brief Value of a successful operation, or the Error it failed with.
+ *
+ * A minimal stand-in for `std::expected<T, Error>` with the same member names, until the library
+ * moves to C++23. value() of a failed result throws its error with internals::throwError(). The
+ * unchecked operator* and operator->, and error() of a successful result, are undefined behavior
+ * on the wrong alternative, so check has_value() first.
+ *
+ * @tparam T The type of the value.
+ */
+template <typename T> class Result
+{
+  public:
+    using value_type = T;
+
+    Result() = default;
+
+    Result(T value) : m_storage(std::in_place_index<0>, std::move(value))
+    {
+    }
+
+    Result(Error error) : m_storage(std::in_place_index<1>, std::move(error))
+    {
+    }
+
+    bool has_value() const noexcept
+    {
+        return m_storage.index() == 0;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return has_value();
+    }
+
+    T &value() &
+    {
+        throwIfError();
+        return **this;
+    }
+
+    const T &value() const &
+    {
+        throwIfError();
+        return **this;
+    }
+
+    T &&value() &&
+    {
+        throwIfError();
+        return *std::move(*this);
+    }
+
+    T &operator*() & noexcept
+    {
+        return *std::get_if<0>(&m_storage);
+    }
+
+    const T &operator*() const & noexcept
+    {
+        return *std::get_if<0>(&m_storage);
+    }
+
+    T &&operator*() && noexcept
+    {
+        return std::move(*std::get_if<0>(&m_storage));
+    }
+
+    T *operator->() noexcept
+    {
+        return std::get_if<0>(&m_storage);
+    }
+
+    const T *operator->() const noexcept
+    {
+        return std::get_if<0>(&m_storage);
+    }
+
+    const Error &error() const noexcept
+    {
+        return *std::get_if<1>(&m_storage);
+    }
+
+  private:
+    void throwIfError() const
+    {
+        if (!has_value())
+        {
+            internals::throwError(error());
+        }
+    }
+
+    std::variant<T, Error> m_storage;
+};
+
+/**
+ * @brief Success without a value, or the Error an operation failed with.
+ */
+template <> class Result<void>
+{
+  public:
+    using value_type = void;
+
+    Result() = default;
+
+    Result(Error error) : m_error(std::move(error))
+    {
+    }
+
+    bool has_value() const noexcept
+    {
+        return !m_error.has_value();
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return has_value();
+    }
+
+    void value() const
+    {
+        if (!has_value())
+        {
+            internals::throwError(*m_error);
+        }
+    }
+
+    const Error &error() const noexcept
+    {
+        return *m_error;
+    }
+
+  private:
+    std::optional<Error> m_error;
+};
+
+namespace internals
+{
+
+/**
+ * @brief Returns the value of a result, or throws its error with throwError().
+ * @param result The result.
+ * @return The value.
+ */
+template <typename T> T unwrap(Result<T> result)
+{
+    if (!result)
+    {
+        throwError(result.error());
+    }
+    if constexpr (!std::is_void_v<T>)
+    {
+        return *std::move(result);
+    }
+}
+
+} // namespace internals
+} // namespace xapi
+
+namespace boost
+{
+namespace system
+{
+
+template <> struct is_error_code_enum<xapi::Errc> : std::true_type
+{
+};
+
+} // namespace system
+} // namespace boost
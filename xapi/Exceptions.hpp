@@ -59,5 +59,28 @@ class ConnectionClosed final : public std::exception
     std::string m_message;
 };
 
+/**
+ * @class RequestTimeout
+ * @brief Exception class to indicate that a request was not answered in time.
+ *
+ * This exception is thrown when the deadline of a request passes before its response arrives.
+ * The connection stays open and a late response is dropped.
+ */
+class RequestTimeout final : public std::exception
+{
+  public:
+    RequestTimeout(const std::string &message) : m_message(message)
+    {
+    }
+
+    const char *what() const noexcept override
+    {
+        return m_message.c_str();
+    }
+
+  private:
+    std::string m_message;
+};
+
 } // namespace exception
 } // namespace xapi
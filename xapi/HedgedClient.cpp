@@ -0,0 +1,191 @@
+#include "HedgedClient.hpp"
+#include <algorithm>
+#include <atomic>
+#include <optional>
+
+namespace xapi
+{
+
+namespace internals
+{
+
+struct HedgingCounters
+{
+    std::atomic<std::uint64_t> requests = 0;
+    std::atomic<std::uint64_t> hedged = 0;
+    std::atomic<std::uint64_t> hedgeWins = 0;
+    std::atomic<std::int64_t> latencySaved = 0;
+};
+
+} // namespace internals
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// State shared by the two attempts of a request, all of them run on the strand of the HedgedClient.
+struct HedgeState
+{
+    HedgeState(const Strand &strand, HedgedClient::Request request, std::shared_ptr<LatencyHistogram> latencyHistogram,
+               std::shared_ptr<internals::HedgingCounters> counters)
+        : wakeUp(strand), request(std::move(request)), latencyHistogram(std::move(latencyHistogram)),
+          counters(std::move(counters)), start(Clock::now())
+    {
+    }
+
+    // Canceled whenever an attempt completes, to wake up the request.
+    boost::asio::steady_timer wakeUp;
+
+    const HedgedClient::Request request;
+    const std::shared_ptr<LatencyHistogram> latencyHistogram;
+    const std::shared_ptr<internals::HedgingCounters> counters;
+    const Clock::time_point start;
+
+    std::optional<boost::json::object> response;
+    std::exception_ptr lastError;
+    std::size_t pendingAttempts = 0;
+
+    // Time from the start until the secondary session answered, set if it won.
+    std::optional<Clock::duration> hedgeWinElapsed;
+};
+
+boost::asio::awaitable<void> attempt(std::shared_ptr<HedgeState> state, XStationClient &client, bool secondary)
+{
+    std::optional<boost::json::object> response;
+    std::exception_ptr error;
+    try
+    {
+        response = co_await state->request(client);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    const Clock::duration elapsed = Clock::now() - state->start;
+    --state->pendingAttempts;
+
+    if (!secondary && response)
+    {
+        state->latencyHistogram->record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed));
+        if (state->hedgeWinElapsed)
+        {
+            const auto saved = std::chrono::duration_cast<std::chrono::microseconds>(elapsed - *state->hedgeWinElapsed);
+            state->counters->latencySaved += saved.count();
+        }
+    }
+
+    if (response && !state->response)
+    {
+        state->response = std::move(response);
+        if (secondary)
+        {
+            state->hedgeWinElapsed = elapsed;
+            ++state->counters->hedgeWins;
+        }
+    }
+    else if (error)
+    {
+        state->lastError = error;
+    }
+    state->wakeUp.cancel();
+}
+
+boost::asio::awaitable<void> waitForAttempts(HedgeState &state, Clock::time_point deadline)
+{
+    boost::system::error_code ignored;
+    state.wakeUp.expires_at(deadline);
+    co_await state.wakeUp.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
+}
+
+} // namespace
+
+HedgedClient::HedgedClient(XStationClient &primary, XStationClient &secondary, const HedgingOptions &options)
+    : m_primary(primary), m_secondary(secondary), m_options(options),
+      m_strand(boost::asio::make_strand(primary.getStrand().get_inner_executor())),
+      m_latencyHistogram(std::make_shared<LatencyHistogram>()),
+      m_counters(std::make_shared<internals::HedgingCounters>())
+{
+}
+
+boost::asio::awaitable<boost::json::object> HedgedClient::getMarginTrade(const std::string &symbol, float volume)
+{
+    return hedge([symbol, volume](XStationClient &client) { return client.getMarginTrade(symbol, volume); });
+}
+
+boost::asio::awaitable<boost::json::object> HedgedClient::getServerTime()
+{
+    return hedge([](XStationClient &client) { return client.getServerTime(); });
+}
+
+boost::asio::awaitable<boost::json::object> HedgedClient::getSymbol(const std::string &symbol)
+{
+    return hedge([symbol](XStationClient &client) { return client.getSymbol(symbol); });
+}
+
+boost::asio::awaitable<boost::json::object> HedgedClient::getTickPrices(const std::vector<std::string> &symbols,
+                                                                        std::int64_t timestamp, int level)
+{
+    return hedge([symbols, timestamp, level](XStationClient &client) {
+        return client.getTickPrices(symbols, timestamp, level);
+    });
+}
+
+boost::asio::awaitable<boost::json::object> HedgedClient::hedge(Request request)
+{
+    return internals::runOnStrand(
+        m_strand, [this, request = std::move(request)]() mutable -> boost::asio::awaitable<boost::json::object> {
+            auto state =
+                std::make_shared<HedgeState>(m_strand, std::move(request), m_latencyHistogram, m_counters);
+            ++m_counters->requests;
+
+            ++state->pendingAttempts;
+            boost::asio::co_spawn(m_strand, attempt(state, m_primary, false), boost::asio::detached);
+            co_await waitForAttempts(*state, state->start + hedgeThreshold());
+
+            if (!state->response)
+            {
+                // The primary session is slow or has failed
+                ++m_counters->hedged;
+                ++state->pendingAttempts;
+                boost::asio::co_spawn(m_strand, attempt(state, m_secondary, true), boost::asio::detached);
+            }
+
+            while (!state->response && state->pendingAttempts > 0)
+            {
+                co_await waitForAttempts(*state, Clock::time_point::max());
+            }
+
+            if (!state->response)
+            {
+                std::rethrow_exception(state->lastError);
+            }
+            co_return std::move(*state->response);
+        });
+}
+
+std::chrono::microseconds HedgedClient::hedgeThreshold() const
+{
+    if (m_latencyHistogram->count() < m_options.minSamples)
+    {
+        return m_options.initialThreshold;
+    }
+    return std::max(m_latencyHistogram->percentile(m_options.percentile), m_options.minThreshold);
+}
+
+HedgingStats HedgedClient::getStats() const
+{
+    HedgingStats stats;
+    stats.requests = m_counters->requests;
+    stats.hedged = m_counters->hedged;
+    stats.hedgeWins = m_counters->hedgeWins;
+    stats.latencySaved = std::chrono::microseconds(m_counters->latencySaved.load());
+    return stats;
+}
+
+std::shared_ptr<const LatencyHistogram> HedgedClient::getLatencyHistogram() const
+{
+    return m_latencyHistogram;
+}
+
+} // namespace xapi
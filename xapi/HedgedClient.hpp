@@ -0,0 +1,120 @@
+#pragma once
+
+/**
+ * @file HedgedClient.hpp
+ * @brief Defines the HedgedClient class for hedging read-only requests across two sessions.
+ *
+ * This file contains the definition of the HedgedClient class, which sends a slow read-only
+ * request again on a second logged-in session and returns the first response.
+ */
+
+#include "HedgingOptions.hpp"
+#include "LatencyHistogram.hpp"
+#include "XStationClient.hpp"
+#include <functional>
+#include <memory>
+
+namespace xapi
+{
+
+namespace internals
+{
+struct HedgingCounters;
+} // namespace internals
+
+/**
+ * @brief Hedges idempotent read-only requests across two logged-in sessions.
+ *
+ * A request is sent on the primary session first. If it is not answered within the hedge
+ * threshold, the same request is sent on the secondary session and the first response wins.
+ * The threshold is a percentile of the recorded latencies of the primary session, so only the
+ * slowest requests, e.g. those stuck behind a stall of one socket, are sent twice.
+ *
+ * The losing request is not canceled, its latency is still recorded when it arrives. Both clients
+ * must outlive the requests sent through the HedgedClient. Only read-only requests may be hedged,
+ * trades would be executed twice.
+ */
+class HedgedClient final
+{
+  public:
+    /**
+     * @brief A read-only request, invoked with the session to send it on.
+     */
+    using Request = std::function<boost::asio::awaitable<boost::json::object>(XStationClient &)>;
+
+    HedgedClient() = delete;
+
+    HedgedClient(const HedgedClient &) = delete;
+    HedgedClient &operator=(const HedgedClient &) = delete;
+
+    /**
+     * @brief Constructs a new HedgedClient object.
+     * @param primary The session requests are sent on first. Must be logged in.
+     * @param secondary The session slow requests are sent on again. Must be logged in.
+     * @param options The options deciding when a request is hedged.
+     */
+    explicit HedgedClient(XStationClient &primary, XStationClient &secondary,
+                          const HedgingOptions &options = HedgingOptions());
+
+    ~HedgedClient() = default;
+
+    boost::asio::awaitable<boost::json::object> getMarginTrade(const std::string &symbol, float volume);
+
+    boost::asio::awaitable<boost::json::object> getServerTime();
+
+    boost::asio::awaitable<boost::json::object> getSymbol(const std::string &symbol);
+
+    boost::asio::awaitable<boost::json::object> getTickPrices(const std::vector<std::string> &symbols,
+                                                              std::int64_t timestamp, int level);
+
+    /**
+     * @brief Sends a read-only request with hedging.
+     *
+     * If the primary session fails before the threshold, the request is sent on the secondary
+     * session at once.
+     *
+     * @param request The request. It may be invoked twice and must not refer to arguments that die
+     *                before the losing request completes, so capture them by value.
+     * @return An awaitable boost::json::object with the first response.
+     * @throw The exception of the secondary session if both sessions fail.
+     */
+    boost::asio::awaitable<boost::json::object> hedge(Request request);
+
+    /**
+     * @brief Gets the time after which a request is currently hedged.
+     * @return The hedge threshold.
+     */
+    std::chrono::microseconds hedgeThreshold() const;
+
+    /**
+     * @brief Gets the statistics of the requests sent so far.
+     * @return The statistics.
+     */
+    HedgingStats getStats() const;
+
+    /**
+     * @brief Gets the histogram of the latencies of the primary session.
+     * @return The histogram the hedge threshold is taken from.
+     */
+    std::shared_ptr<const LatencyHistogram> getLatencyHistogram() const;
+
+  private:
+    // Session requests are sent on first.
+    XStationClient &m_primary;
+
+    // Session slow requests are sent on again.
+    XStationClient &m_secondary;
+
+    const HedgingOptions m_options;
+
+    // Strand the state of the hedged requests is accessed on.
+    Strand m_strand;
+
+    // Latencies of the primary session.
+    std::shared_ptr<LatencyHistogram> m_latencyHistogram;
+
+    // Counters of getStats(), shared with the losing requests that complete later.
+    std::shared_ptr<internals::HedgingCounters> m_counters;
+};
+
+} // namespace xapi
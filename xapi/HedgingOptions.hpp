@@ -0,0 +1,76 @@
+#pragma once
+
+/**
+ * @file HedgingOptions.hpp
+ * @brief Defines the options and statistics of hedged requests.
+ */
+
+#include <chrono>
+#include <cstdint>
+
+namespace xapi
+{
+
+/**
+ * @brief Options of HedgedClient, deciding when a request is sent again on the second session.
+ */
+struct HedgingOptions
+{
+    /**
+     * Percentile of the latencies of the first session after which a request is hedged.
+     */
+    double percentile = 95.0;
+
+    /**
+     * Number of latencies to record before the percentile is used instead of initialThreshold.
+     */
+    std::uint64_t minSamples = 20;
+
+    /**
+     * Time after which a request is hedged until minSamples latencies are recorded.
+     */
+    std::chrono::microseconds initialThreshold = std::chrono::milliseconds(50);
+
+    /**
+     * Lower bound of the threshold, so that fast sessions do not hedge every small jitter.
+     */
+    std::chrono::microseconds minThreshold = std::chrono::milliseconds(1);
+};
+
+/**
+ * @brief Statistics of the requests sent through a HedgedClient.
+ */
+struct HedgingStats
+{
+    /**
+     * Number of requests.
+     */
+    std::uint64_t requests = 0;
+
+    /**
+     * Number of requests sent again on the second session.
+     */
+    std::uint64_t hedged = 0;
+
+    /**
+     * Number of hedged requests answered first by the second session.
+     */
+    std::uint64_t hedgeWins = 0;
+
+    /**
+     * Sum of the time by which the second session beat the first one. Only hedge wins whose
+     * late response from the first session has arrived are counted.
+     */
+    std::chrono::microseconds latencySaved{0};
+
+    /**
+     * @brief Gets the share of hedged requests.
+     * @return The number of hedged requests divided by the number of requests, zero if there were none.
+     */
+    double hedgeRate() const
+    {
+        return requests == 0 ? 0.0 : static_cast<double>(hedged) / static_cast<double>(requests);
+    }
+};
+
+} // namespace xapi
@@ -5,10 +5,15 @@
  * @brief Declaration of the Connection interface.
  */
 
+#include "Error.hpp"
+#include "Exceptions.hpp"
+#include "LatencyHistogram.hpp"
 #include <boost/asio.hpp>
 #include <boost/asio/cancellation_signal.hpp>
 #include <boost/json.hpp>
 #include <boost/url.hpp>
+#include <memory>
+#include <string_view>
 
 namespace xapi
 {
@@ -42,12 +47,88 @@ class IConnection
      */
     virtual boost::asio::awaitable<void> makeRequest(const boost::json::object &command) = 0;
 
+    /**
+     * @brief Sends an already serialized command to the server.
+     * @param message The serialized command. Must stay valid until the returned awaitable completes.
+     * @return An awaitable void.
+     * @throw xapi::exception::ConnectionClosed if the request fails.
+     */
+    virtual boost::asio::awaitable<void> sendMessage(std::string_view message) = 0;
+
     /**
      * @brief Waits for a response from the server.
      * @return An awaitable boost::json::object with response from the server.
      * @throw xapi::exception::ConnectionClosed if the response fails.
      */
     virtual boost::asio::awaitable<boost::json::object> waitResponse() = 0;
+
+    /**
+     * @brief Gets the histogram of the keep-alive ping round trips.
+     * @return The histogram, or nullptr if the connection does not measure round trips.
+     */
+    virtual std::shared_ptr<const LatencyHistogram> getRttHistogram() const = 0;
+
+    /**
+     * @brief Establishes the connection, reporting a failure as Errc::ConnectionClosed instead of throwing.
+     *
+     * The default implementation wraps connect(). Connections on hot paths override it, and the
+     * throwing method, so that no exception is thrown on failure.
+     *
+     * @param url The URL to connect to.
+     * @return An awaitable Result.
+     */
+    virtual boost::asio::awaitable<Result<void>> tryConnect(const boost::url &url)
+    {
+        try
+        {
+            co_await connect(url);
+        }
+        catch (const std::exception &e)
+        {
+            co_return Error::make(Errc::ConnectionClosed, e.what());
+        }
+        co_return Result<void>();
+    }
+
+    /**
+     * @brief Sends an already serialized command, reporting a failure as Errc::ConnectionClosed instead of throwing.
+     *
+     * The default implementation wraps sendMessage().
+     *
+     * @param message The serialized command. Must stay valid until the returned awaitable completes.
+     * @return An awaitable Result.
+     */
+    virtual boost::asio::awaitable<Result<void>> trySendMessage(std::string_view message)
+    {
+        try
+        {
+            co_await sendMessage(message);
+        }
+        catch (const std::exception &e)
+        {
+            co_return Error::make(Errc::ConnectionClosed, e.what());
+        }
+        co_return Result<void>();
+    }
+
+    /**
+     * @brief Waits for a response, reporting a failure as Errc::ConnectionClosed instead of throwing.
+     *
+     * The default implementation wraps waitResponse().
+     *
+     * @return An awaitable Result with the response from the server.
+     */
+    virtual boost::asio::awaitable<Result<boost::json::object>> tryWaitResponse()
+    {
+        try
+        {
+            co_return co_await waitResponse();
+        }
+        catch (const std::exception &e)
+        {
+            co_return Error::make(Errc::ConnectionClosed, e.what());
+        }
+    }
 };
 
 } // namespace internals
@@ -0,0 +1,120 @@
+#include "LatencyHistogram.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace xapi
+{
+
+LatencyHistogram::LatencyHistogram()
+    : m_buckets(), m_count(0), m_sum(0), m_min(std::numeric_limits<std::uint64_t>::max()), m_max(0)
+{
+}
+
+void LatencyHistogram::record(std::chrono::microseconds latency)
+{
+    const std::uint64_t value = std::min(static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count(), 0)), m_maxValue);
+
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    auto min = m_min.load(std::memory_order_relaxed);
+    while (value < min && !m_min.compare_exchange_weak(min, value, std::memory_order_relaxed))
+    {
+    }
+    auto max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+std::uint64_t LatencyHistogram::count() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+std::chrono::microseconds LatencyHistogram::min() const
+{
+    return count() == 0 ? std::chrono::microseconds(0)
+                        : std::chrono::microseconds(m_min.load(std::memory_order_relaxed));
+}
+
+std::chrono::microseconds LatencyHistogram::max() const
+{
+    return std::chrono::microseconds(m_max.load(std::memory_order_relaxed));
+}
+
+std::chrono::microseconds LatencyHistogram::mean() const
+{
+    const auto total = count();
+    return total == 0 ? std::chrono::microseconds(0)
+                      : std::chrono::microseconds(m_sum.load(std::memory_order_relaxed) / total);
+}
+
+std::chrono::microseconds LatencyHistogram::percentile(double percentile) const
+{
+    const auto total = count();
+    if (total == 0)
+    {
+        return std::chrono::microseconds(0);
+    }
+
+    const double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+    const auto target = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(fraction * total)), 1);
+
+    std::uint64_t seen = 0;
+    for (std::size_t index = 0; index < m_bucketCount; ++index)
+    {
+        seen += m_buckets[index].load(std::memory_order_relaxed);
+        if (seen >= target)
+        {
+            // The bucket bound may lie past the largest recorded value
+            return std::min(std::chrono::microseconds(bucketHighestValue(index)), max());
+        }
+    }
+    return max();
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : m_buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+std::size_t LatencyHistogram::bucketIndex(std::uint64_t value)
+{
+    if (value < m_subBucketCount)
+    {
+        return static_cast<std::size_t>(value);
+    }
+
+    // Values of the same magnitude share one range of half as many buckets, each twice as wide
+    // as in the previous magnitude
+    const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - m_subBucketBits;
+    const std::uint64_t subBucket = value >> shift;
+    return static_cast<std::size_t>(m_subBucketCount + (shift - 1) * m_subBucketHalfCount +
+                                    (subBucket - m_subBucketHalfCount));
+}
+
+std::uint64_t LatencyHistogram::bucketHighestValue(std::size_t index)
+{
+    if (index < m_subBucketCount)
+    {
+        return index;
+    }
+
+    const std::uint64_t offset = index - m_subBucketCount;
+    const unsigned shift = static_cast<unsigned>(offset / m_subBucketHalfCount) + 1;
+    const std::uint64_t subBucket = offset % m_subBucketHalfCount + m_subBucketHalfCount;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+} // namespace xapi
@@ -0,0 +1,122 @@
+#pragma once
+
+/**
+ * @file LatencyHistogram.hpp
+ * @brief Defines the LatencyHistogram class for recording latencies.
+ *
+ * This file contains the definition of the LatencyHistogram class, a histogram with log-linear
+ * buckets in the style of HdrHistogram, used e.g. for the ping round trips of connections.
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace xapi
+{
+
+/**
+ * @class LatencyHistogram
+ * @brief Histogram of latencies with a bounded relative error.
+ *
+ * Latencies are recorded in microseconds. Values below 128 µs are kept exactly, larger ones in
+ * buckets whose width is 1/64 of their magnitude, so every percentile is accurate to within 1.6%.
+ * Values above about 71 minutes are recorded as the largest bucket.
+ *
+ * Recording and reading are lock free, so the histogram may be read from any thread while a
+ * connection records into it.
+ */
+class LatencyHistogram final
+{
+  public:
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    /**
+     * @brief Constructs a new, empty LatencyHistogram object.
+     */
+    LatencyHistogram();
+
+    ~LatencyHistogram() = default;
+
+    /**
+     * @brief Records a latency.
+     * @param latency The latency, negative values are recorded as zero.
+     */
+    void record(std::chrono::microseconds latency);
+
+    /**
+     * @brief Gets the number of recorded latencies.
+     * @return The number of recorded latencies.
+     */
+    std::uint64_t count() const;
+
+    /**
+     * @brief Gets the smallest recorded latency.
+     * @return The smallest recorded latency, zero if the histogram is empty.
+     */
+    std::chrono::microseconds min() const;
+
+    /**
+     * @brief Gets the largest recorded latency.
+     * @return The largest recorded latency, zero if the histogram is empty.
+     */
+    std::chrono::microseconds max() const;
+
+    /**
+     * @brief Gets the mean of the recorded latencies.
+     * @return The mean latency, zero if the histogram is empty.
+     */
+    std::chrono::microseconds mean() const;
+
+    /**
+     * @brief Gets the latency below which the given percentage of the recorded latencies fall.
+     * @param percentile The percentile, from 0 to 100.
+     * @return The highest latency of the bucket the percentile falls into, zero if the histogram is empty.
+     */
+    std::chrono::microseconds percentile(double percentile) const;
+
+    /**
+     * @brief Drops all recorded latencies.
+     *
+     * Latencies recorded concurrently with the reset may be partially kept.
+     */
+    void reset();
+
+  private:
+    // Latencies below 2^m_subBucketBits are kept exactly.
+    static constexpr unsigned m_subBucketBits = 7;
+    static constexpr std::uint64_t m_subBucketCount = std::uint64_t(1) << m_subBucketBits;
+    static constexpr std::uint64_t m_subBucketHalfCount = m_subBucketCount / 2;
+
+    // Largest latency with its own bucket, about 71 minutes.
+    static constexpr unsigned m_maxValueBits = 32;
+    static constexpr std::uint64_t m_maxValue = (std::uint64_t(1) << m_maxValueBits) - 1;
+
+    static constexpr std::size_t m_bucketCount =
+        m_subBucketCount + (m_maxValueBits - m_subBucketBits) * m_subBucketHalfCount;
+
+    /**
+     * @brief Gets the bucket of a latency.
+     * @param value The latency in microseconds, at most m_maxValue.
+     * @return The index of the bucket.
+     */
+    static std::size_t bucketIndex(std::uint64_t value);
+
+    /**
+     * @brief Gets the highest latency recorded in a bucket.
+     * @param index The index of the bucket.
+     * @return The highest latency of the bucket in microseconds.
+     */
+    static std::uint64_t bucketHighestValue(std::size_t index);
+
+    std::array<std::atomic<std::uint64_t>, m_bucketCount> m_buckets;
+    std::atomic<std::uint64_t> m_count;
+    std::atomic<std::uint64_t> m_sum;
+    std::atomic<std::uint64_t> m_min;
+    std::atomic<std::uint64_t> m_max;
+};
+
+} // namespace xapi
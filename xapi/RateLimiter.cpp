@@ -0,0 +1,49 @@
+#include "RateLimiter.hpp"
+#include <algorithm>
+
+namespace xapi
+{
+
+RateLimiter::RateLimiter(Clock::duration interval, std::size_t burst)
+    : m_interval(interval), m_burstWindow(interval * static_cast<Clock::rep>(std::max<std::size_t>(burst, 1) - 1)),
+      m_mutex(), m_nextToken(Clock::time_point::min())
+{
+}
+
+boost::asio::awaitable<void> RateLimiter::acquire()
+{
+    const auto sendTime = reserve();
+    if (sendTime > Clock::now())
+    {
+        boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor);
+        timer.expires_at(sendTime);
+        co_await timer.async_wait(boost::asio::use_awaitable);
+    }
+}
+
+bool RateLimiter::tryAcquire()
+{
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto token = std::max(m_nextToken, now);
+    if (token - m_burstWindow > now)
+    {
+        return false;
+    }
+    m_nextToken = token + m_interval;
+    return true;
+}
+
+RateLimiter::Clock::time_point RateLimiter::reserve()
+{
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Idle time adds tokens only up to the capacity of the bucket
+    const auto token = std::max(m_nextToken, now);
+    m_nextToken = token + m_interval;
+    return std::max(token - m_burstWindow, now);
+}
+
+} // namespace xapi
@@ -0,0 +1,106 @@
+#pragma once
+
+/**
+ * @file RateLimiter.hpp
+ * @brief Defines the rate limiters for outgoing requests.
+ *
+ * This file contains the definition of the IRateLimiter interface and of the RateLimiter class,
+ * a token bucket used by connections to keep requests within the xAPI limits.
+ */
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace xapi
+{
+
+/**
+ * @class IRateLimiter
+ * @brief Interface of the rate limiters used by connections.
+ */
+class IRateLimiter
+{
+  public:
+    virtual ~IRateLimiter() = default;
+
+    /**
+     * @brief Waits until one more request may be sent.
+     * @return An awaitable void, completes when the request may be sent.
+     */
+    virtual boost::asio::awaitable<void> acquire() = 0;
+
+    /**
+     * @brief Takes a token if one is available right now.
+     *
+     * Used to add more queued requests to a coalesced write. Limiters that do not implement it
+     * never coalesce requests.
+     *
+     * @return True if the request may be sent now, false if it has to wait in acquire().
+     */
+    virtual bool tryAcquire()
+    {
+        return false;
+    }
+};
+
+/**
+ * @class RateLimiter
+ * @brief Token bucket rate limiter on a monotonic clock.
+ *
+ * The bucket holds up to `burst` tokens and gets a new one every `interval`. A request that finds
+ * the bucket empty reserves the next token and waits for it on a timer, so waiting requests are
+ * served in order of arrival and no thread is blocked. The limiter is thread safe and one instance
+ * may be shared by several connections, e.g. the main and stream connections of one account.
+ */
+class RateLimiter final : public IRateLimiter
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    RateLimiter(const RateLimiter &) = delete;
+    RateLimiter &operator=(const RateLimiter &) = delete;
+
+    /**
+     * @brief Constructs a new RateLimiter object.
+     * @param interval Time in which the bucket gets a new token.
+     * @param burst Number of tokens the bucket holds, i.e. how many requests may be sent at once.
+     */
+    explicit RateLimiter(Clock::duration interval = std::chrono::milliseconds(200), std::size_t burst = 1);
+
+    ~RateLimiter() override = default;
+
+    /**
+     * @brief Waits until one more request may be sent.
+     * @return An awaitable void, completes when the request may be sent.
+     */
+    boost::asio::awaitable<void> acquire() override;
+
+    /**
+     * @brief Takes a token if one is available right now.
+     * @return True if the request may be sent now, false if the bucket is empty.
+     */
+    bool tryAcquire() override;
+
+    /**
+     * @brief Reserves a token without waiting for it.
+     * @return The time point from which the request may be sent.
+     */
+    Clock::time_point reserve();
+
+  private:
+    // Time in which the bucket gets a new token.
+    const Clock::duration m_interval;
+
+    // Time in which an empty bucket fills up, less one interval.
+    const Clock::duration m_burstWindow;
+
+    // Protects m_nextToken, the limiter may be shared between threads.
+    std::mutex m_mutex;
+
+    // Time at which the token after the last reserved one is generated.
+    Clock::time_point m_nextToken;
+};
+
+} // namespace xapi
@@ -0,0 +1,28 @@
+#include "ReconnectPolicy.hpp"
+#include <algorithm>
+
+namespace xapi
+{
+
+Backoff::Backoff(const ReconnectPolicy &policy)
+    : m_policy(policy), m_delay(static_cast<double>(policy.initialDelay.count())), m_random(std::random_device()())
+{
+}
+
+std::chrono::milliseconds Backoff::nextDelay()
+{
+    const double maxDelay = static_cast<double>(m_policy.maxDelay.count());
+    const double delay = std::min(m_delay, maxDelay);
+    m_delay = std::min(m_delay * m_policy.multiplier, maxDelay);
+
+    const double jitter = std::clamp(m_policy.jitter, 0.0, 1.0);
+    std::uniform_real_distribution<double> distribution(1.0 - jitter, 1.0);
+    return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(delay * distribution(m_random)));
+}
+
+void Backoff::reset()
+{
+    m_delay = static_cast<double>(m_policy.initialDelay.count());
+}
+
+} // namespace xapi
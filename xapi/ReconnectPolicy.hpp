@@ -0,0 +1,85 @@
+#pragma once
+
+/**
+ * @file ReconnectPolicy.hpp
+ * @brief Defines the reconnect policy of the streams and the Backoff class computing its delays.
+ */
+
+#include <chrono>
+#include <random>
+
+namespace xapi
+{
+
+/**
+ * @brief Policy of XStationClientStream for reconnecting after the connection drops.
+ */
+struct ReconnectPolicy
+{
+    /**
+     * Flag to enable automatic reconnects. If false, XStationClientStream::listen() throws
+     * when the connection drops.
+     */
+    bool enabled = false;
+
+    /**
+     * Delay before the first reconnect attempt.
+     */
+    std::chrono::milliseconds initialDelay = std::chrono::milliseconds(100);
+
+    /**
+     * Upper bound of the delay between attempts.
+     */
+    std::chrono::milliseconds maxDelay = std::chrono::seconds(10);
+
+    /**
+     * Factor the delay grows by after every failed attempt.
+     */
+    double multiplier = 2.0;
+
+    /**
+     * Fraction of the delay that is randomized, from 0 (fixed delays) to 1 (anywhere between
+     * zero and the full delay). Keeps many clients dropped at once from reconnecting in lockstep.
+     */
+    double jitter = 0.5;
+
+    /**
+     * Number of attempts before giving up, 0 for no limit.
+     */
+    int maxAttempts = 0;
+};
+
+/**
+ * @class Backoff
+ * @brief Jittered exponential backoff following a ReconnectPolicy.
+ */
+class Backoff final
+{
+  public:
+    /**
+     * @brief Constructs a new Backoff object.
+     * @param policy The policy to follow.
+     */
+    explicit Backoff(const ReconnectPolicy &policy);
+
+    /**
+     * @brief Computes the delay before the next attempt and grows the following one.
+     * @return The delay, between `(1 - jitter)` times and the full current delay.
+     */
+    std::chrono::milliseconds nextDelay();
+
+    /**
+     * @brief Restarts from the initial delay, e.g. after a successful attempt.
+     */
+    void reset();
+
+  private:
+    const ReconnectPolicy m_policy;
+
+    // Delay of the next attempt before jitter, in milliseconds.
+    double m_delay;
+
+    std::minstd_rand m_random;
+};
+
+} // namespace xapi
@@ -0,0 +1,75 @@
+#include "ResolverCache.hpp"
+
+namespace xapi
+{
+
+ResolverCache::ResolverCache(Clock::duration timeToLive) : m_timeToLive(timeToLive), m_mutex(), m_entries()
+{
+}
+
+boost::asio::awaitable<ResolverCache::Endpoints> ResolverCache::resolve(std::string_view host, std::string_view port)
+{
+    boost::system::error_code error;
+    auto endpoints = co_await resolve(host, port, error);
+    if (error)
+    {
+        throw boost::system::system_error(error);
+    }
+    co_return endpoints;
+}
+
+boost::asio::awaitable<ResolverCache::Endpoints> ResolverCache::resolve(std::string_view host, std::string_view port,
+                                                                        boost::system::error_code &error)
+{
+    error = {};
+    const std::string key = makeKey(host, port);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto entry = m_entries.find(key);
+        if (entry != m_entries.end() && entry->second.expiresAt > Clock::now())
+        {
+            co_return entry->second.endpoints;
+        }
+    }
+
+    boost::asio::ip::tcp::resolver resolver(co_await boost::asio::this_coro::executor);
+    const auto results =
+        co_await resolver.async_resolve(host, port, boost::asio::redirect_error(boost::asio::use_awaitable, error));
+    if (error)
+    {
+        co_return Endpoints();
+    }
+
+    Endpoints endpoints;
+    endpoints.reserve(results.size());
+    for (const auto &result : results)
+    {
+        endpoints.push_back(result.endpoint());
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.insert_or_assign(key, Entry{endpoints, Clock::now() + m_timeToLive});
+    co_return endpoints;
+}
+
+void ResolverCache::invalidate(std::string_view host, std::string_view port)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(makeKey(host, port));
+}
+
+std::size_t ResolverCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+std::string ResolverCache::makeKey(std::string_view host, std::string_view port)
+{
+    std::string key;
+    key.reserve(host.size() + port.size() + 1);
+    key.append(host).append(":").append(port);
+    return key;
+}
+
+} // namespace xapi
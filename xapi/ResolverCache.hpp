@@ -0,0 +1,104 @@
+#pragma once
+
+/**
+ * @file ResolverCache.hpp
+ * @brief Defines the ResolverCache class for caching DNS results.
+ *
+ * This file contains the definition of the ResolverCache class, which keeps resolved endpoints
+ * for a limited time so that reconnects skip the resolver.
+ */
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace xapi
+{
+
+/**
+ * @class ResolverCache
+ * @brief Cache of resolved endpoints with a fixed time to live.
+ *
+ * The cache is thread safe and one instance may be shared by all connections. A connection that
+ * fails to reach any endpoint of a cached result invalidates it, so the next attempt resolves again.
+ */
+class ResolverCache final
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Endpoints = std::vector<boost::asio::ip::tcp::endpoint>;
+
+    ResolverCache(const ResolverCache &) = delete;
+    ResolverCache &operator=(const ResolverCache &) = delete;
+
+    /**
+     * @brief Constructs a new ResolverCache object.
+     * @param timeToLive Time for which a resolved result is reused.
+     */
+    explicit ResolverCache(Clock::duration timeToLive = std::chrono::minutes(5));
+
+    ~ResolverCache() = default;
+
+    /**
+     * @brief Resolves the host, or returns the cached result if it is still fresh.
+     * @param host The host name.
+     * @param port The port or service name.
+     * @return An awaitable with the resolved endpoints.
+     * @throw boost::system::system_error if the host cannot be resolved.
+     */
+    boost::asio::awaitable<Endpoints> resolve(std::string_view host, std::string_view port);
+
+    /**
+     * @brief Resolves the host, or returns the cached result if it is still fresh, without throwing.
+     * @param host The host name.
+     * @param port The port or service name.
+     * @param error Set to the error if the host cannot be resolved.
+     * @return An awaitable with the resolved endpoints, empty on error.
+     */
+    boost::asio::awaitable<Endpoints> resolve(std::string_view host, std::string_view port,
+                                              boost::system::error_code &error);
+
+    /**
+     * @brief Drops the cached result of the host, e.g. after none of its endpoints could be reached.
+     * @param host The host name.
+     * @param port The port or service name.
+     */
+    void invalidate(std::string_view host, std::string_view port);
+
+    /**
+     * @brief Gets the number of cached results, including expired ones not yet replaced.
+     * @return The number of cached results.
+     */
+    std::size_t size() const;
+
+  private:
+    struct Entry
+    {
+        Endpoints endpoints;
+        Clock::time_point expiresAt;
+    };
+
+    /**
+     * @brief Builds the key of a cached result.
+     * @param host The host name.
+     * @param port The port or service name.
+     * @return The cache key.
+     */
+    static std::string makeKey(std::string_view host, std::string_view port);
+
+    // Time for which a resolved result is reused.
+    const Clock::duration m_timeToLive;
+
+    // Protects m_entries, the cache may be shared between threads.
+    mutable std::mutex m_mutex;
+
+    // Resolved results by host and port.
+    std::unordered_map<std::string, Entry> m_entries;
+};
+
+} // namespace xapi
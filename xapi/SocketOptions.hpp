@@ -0,0 +1,51 @@
+#pragma once
+
+/**
+ * @file SocketOptions.hpp
+ * @brief Defines the options applied to the TCP sockets of the connections.
+ */
+
+#include <optional>
+
+namespace xapi
+{
+
+/**
+ * @brief TCP socket options applied by the connections once the socket is connected.
+ *
+ * Options left empty keep the default of the operating system.
+ */
+struct SocketOptions
+{
+    /**
+     * Disables Nagle's algorithm (TCP_NODELAY), so small commands are sent at once instead of
+     * waiting for the acknowledgement of the previous segment.
+     */
+    bool noDelay = true;
+
+    /**
+     * Size of the receive buffer in bytes (SO_RCVBUF).
+     */
+    std::optional<int> receiveBufferSize;
+
+    /**
+     * Size of the send buffer in bytes (SO_SNDBUF).
+     */
+    std::optional<int> sendBufferSize;
+
+    /**
+     * Busy poll budget of the socket in microseconds (SO_BUSY_POLL). Only takes effect when
+     * busy polling is enabled system wide with net.core.busy_poll. Linux only, ignored elsewhere.
+     * Best effort, raising it above the system default needs CAP_NET_ADMIN and is skipped without.
+     */
+    std::optional<int> busyPoll;
+
+    /**
+     * Acknowledges received segments at once instead of delaying the acknowledgement (TCP_QUICKACK).
+     * The kernel clears the flag again, so it is set after every received message. Linux only,
+     * ignored elsewhere.
+     */
+    bool quickAck = false;
+};
+
+} // namespace xapi
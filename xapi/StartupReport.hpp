@@ -0,0 +1,42 @@
+#pragma once
+
+/**
+ * @file StartupReport.hpp
+ * @brief Defines the StartupReport structure with the time spent in each startup phase.
+ */
+
+#include <chrono>
+
+namespace xapi
+{
+
+/**
+ * @brief Time spent in each phase of XStationClient::loginWithStream().
+ *
+ * The stream is opened while the client connects and logs in, so streamOpen overlaps
+ * connect and login, and total is less than their sum.
+ */
+struct StartupReport
+{
+    /**
+     * TCP, TLS and WebSocket handshakes of the client connection.
+     */
+    std::chrono::microseconds connect{0};
+
+    /**
+     * Round trip of the login command.
+     */
+    std::chrono::microseconds login{0};
+
+    /**
+     * TCP, TLS and WebSocket handshakes of the stream connection.
+     */
+    std::chrono::microseconds streamOpen{0};
+
+    /**
+     * Time from the start of the startup until the stream session ID is set on the stream.
+     */
+    std::chrono::microseconds total{0};
+};
+
+} // namespace xapi
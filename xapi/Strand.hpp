@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * @file Strand.hpp
+ * @brief Defines the strand the clients and connections are bound to.
+ *
+ * Every client and connection runs its handlers on its own strand, so a single
+ * io_context may be run from several threads without data races.
+ */
+
+#include <boost/asio.hpp>
+#include <cstddef>
+#include <exception>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace xapi
+{
+
+/**
+ * @brief Strand of an io_context, serializing the handlers of one client or connection.
+ */
+using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+namespace internals
+{
+
+/**
+ * @brief Runs an operation on the strand and resumes the caller on its own executor.
+ *
+ * If the caller already runs on the strand, the operation is awaited directly without a hop.
+ *
+ * @param strand The strand to run the operation on.
+ * @param operation Callable returning the awaitable to run. It is invoked on the strand and
+ *                  kept alive until the awaitable completes.
+ * @return An awaitable with the result of the operation.
+ */
+template <typename Operation>
+auto runOnStrand(Strand strand, Operation operation) -> decltype(operation())
+{
+    if (strand.running_in_this_thread())
+    {
+        co_return co_await operation();
+    }
+    co_return co_await boost::asio::co_spawn(strand, operation(), boost::asio::use_awaitable);
+}
+
+/**
+ * @brief Completion signature of an operation returning boost::asio::awaitable<T>.
+ */
+template <typename T> struct CompletionSignature
+{
+    using type = void(std::exception_ptr, T);
+};
+
+template <> struct CompletionSignature<void>
+{
+    using type = void(std::exception_ptr);
+};
+
+/**
+ * @brief Runs an operation on the strand and completes any completion token with its result.
+ *
+ * The completion signature is `void(std::exception_ptr, T)` for an awaitable T, or
+ * `void(std::exception_ptr)` for an awaitable void, as for boost::asio::co_spawn(). The token may
+ * be a callback, boost::asio::deferred, boost::asio::use_future, boost::asio::as_tuple() or
+ * anything else asio accepts, and a parallel group cancels the operation through its slot. A
+ * handler without an associated executor is invoked on the strand.
+ *
+ * @param strand The strand to run the operation on.
+ * @param operation Callable returning the awaitable to run. It is invoked on the strand and kept
+ *                  alive until the awaitable completes, so it should own the arguments it captures.
+ * @param token The completion token.
+ * @return Whatever the completion token returns, e.g. void for a callback.
+ */
+template <typename Operation, typename CompletionToken>
+auto asyncRunOnStrand(Strand strand, Operation operation, CompletionToken &&token)
+{
+    using Signature =
+        typename CompletionSignature<typename std::invoke_result_t<Operation &>::value_type>::type;
+
+    return boost::asio::async_initiate<CompletionToken, Signature>(
+        [strand](auto handler, Operation initiatedOperation) {
+            boost::asio::co_spawn(strand, std::move(initiatedOperation), std::move(handler));
+        },
+        token, std::move(operation));
+}
+
+/**
+ * @brief Starts an awaitable method on the strand and completes any completion token with its result.
+ *
+ * The generic body of the `async()` methods of the client and the stream, see asyncRunOnStrand().
+ * The arguments before the token are copied into the operation. An argument passed with std::ref()
+ * reaches the method as a reference and must outlive the operation.
+ *
+ * @tparam Method The method, returning an awaitable.
+ * @param strand The strand to run the method on.
+ * @param object The object to call the method on. Must outlive the operation.
+ * @param argumentsAndToken The arguments of the method followed by the completion token.
+ * @return Whatever the completion token returns, e.g. void for a callback.
+ */
+template <auto Method, typename Object, typename... ArgumentsAndToken>
+auto asyncInvoke(Strand strand, Object &object, ArgumentsAndToken &&...argumentsAndToken)
+{
+    static_assert(sizeof...(ArgumentsAndToken) > 0, "The completion token is missing");
+    constexpr std::size_t argumentCount = sizeof...(ArgumentsAndToken) - 1;
+
+    auto forwarded = std::forward_as_tuple(std::forward<ArgumentsAndToken>(argumentsAndToken)...);
+    return [&]<std::size_t... Index>(std::index_sequence<Index...>) {
+        return asyncRunOnStrand(
+            std::move(strand),
+            [&object, arguments = std::make_tuple(std::get<Index>(std::move(forwarded))...)]() mutable {
+                return std::apply([&object](auto &...values) { return (object.*Method)(values...); }, arguments);
+            },
+            std::get<argumentCount>(std::move(forwarded)));
+    }(std::make_index_sequence<argumentCount>());
+}
+
+} // namespace internals
+} // namespace xapi
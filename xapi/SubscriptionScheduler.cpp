@@ -0,0 +1,160 @@
+#include "SubscriptionScheduler.hpp"
+#include "Exceptions.hpp"
+#include <stdexcept>
+
+namespace xapi
+{
+
+namespace
+{
+
+// The scheduler runs on the io_context of its first stream.
+boost::asio::io_context::executor_type firstExecutor(
+    const std::vector<std::reference_wrapper<XStationClientStream>> &streams)
+{
+    if (streams.empty())
+    {
+        throw std::invalid_argument("The scheduler needs at least one stream");
+    }
+    return streams.front().get().getStrand().get_inner_executor();
+}
+
+} // namespace
+
+SubscriptionScheduler::SubscriptionScheduler(std::vector<std::reference_wrapper<XStationClientStream>> streams)
+    : m_streams(std::move(streams)), m_strand(boost::asio::make_strand(firstExecutor(m_streams))), m_queue(),
+      m_nextSequence(0), m_workerRunning(m_streams.size(), false), m_streamFailed(m_streams.size(), false),
+      m_inFlight(0), m_wakeUp(m_strand, boost::asio::steady_timer::time_point::max()), m_total(0), m_live(0),
+      m_failed(0)
+{
+}
+
+boost::asio::awaitable<void> SubscriptionScheduler::schedule(std::vector<Subscription> subscriptions)
+{
+    return internals::runOnStrand(
+        m_strand, [this, subscriptions = std::move(subscriptions)]() mutable -> boost::asio::awaitable<void> {
+            for (auto &subscription : subscriptions)
+            {
+                m_queue.push(QueuedSubscription{std::move(subscription), m_nextSequence++});
+            }
+            m_total += subscriptions.size();
+            startWorkers();
+            co_return;
+        });
+}
+
+boost::asio::awaitable<SubscriptionProgress> SubscriptionScheduler::waitLive()
+{
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<SubscriptionProgress> {
+        while (!isDone())
+        {
+            boost::system::error_code ignored;
+            co_await m_wakeUp.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
+        }
+        co_return getProgress();
+    });
+}
+
+SubscriptionProgress SubscriptionScheduler::getProgress() const
+{
+    SubscriptionProgress progress;
+    progress.live = m_live;
+    progress.failed = m_failed;
+    progress.total = m_total;
+    return progress;
+}
+
+boost::asio::awaitable<void> SubscriptionScheduler::runWorker(std::size_t index)
+{
+    while (!m_queue.empty())
+    {
+        QueuedSubscription next = m_queue.top();
+        m_queue.pop();
+        ++m_inFlight;
+
+        bool streamFailed = false;
+        bool rejected = false;
+        try
+        {
+            co_await subscribe(m_streams[index], next.subscription);
+        }
+        catch (const exception::ConnectionClosed &)
+        {
+            streamFailed = true;
+        }
+        catch (...)
+        {
+            // Anything else is a problem of the subscription, not of the stream. It must not escape
+            // the detached worker, or waitLive() would wait for it forever.
+            rejected = true;
+        }
+        --m_inFlight;
+
+        if (rejected)
+        {
+            ++m_failed;
+            m_wakeUp.cancel();
+            continue;
+        }
+
+        if (streamFailed)
+        {
+            // Taken over by another stream, which may have gone idle meanwhile
+            m_streamFailed[index] = true;
+            m_workerRunning[index] = false;
+            m_queue.push(std::move(next));
+            startWorkers();
+            co_return;
+        }
+
+        ++m_live;
+        m_wakeUp.cancel();
+    }
+    m_workerRunning[index] = false;
+}
+
+void SubscriptionScheduler::startWorkers()
+{
+    bool streamLeft = false;
+    for (std::size_t i = 0; i < m_streams.size(); ++i)
+    {
+        if (m_streamFailed[i])
+        {
+            continue;
+        }
+        streamLeft = true;
+        if (!m_workerRunning[i])
+        {
+            m_workerRunning[i] = true;
+            boost::asio::co_spawn(m_strand, runWorker(i), boost::asio::detached);
+        }
+    }
+
+    if (!streamLeft)
+    {
+        m_failed += m_queue.size();
+        m_queue = {};
+        m_wakeUp.cancel();
+    }
+}
+
+boost::asio::awaitable<void> SubscriptionScheduler::subscribe(XStationClientStream &stream,
+                                                              const Subscription &subscription)
+{
+    switch (subscription.type)
+    {
+    case SubscriptionType::Candles:
+        co_await stream.getCandles(subscription.symbol);
+        break;
+    case SubscriptionType::TickPrices:
+        co_await stream.getTickPrices(subscription.symbol, subscription.minArrivalTime, subscription.maxLevel);
+        break;
+    }
+}
+
+bool SubscriptionScheduler::isDone() const
+{
+    return m_queue.empty() && m_inFlight == 0;
+}
+
+} // namespace xapi
@@ -0,0 +1,219 @@
+#pragma once
+
+/**
+ * @file SubscriptionScheduler.hpp
+ * @brief Defines the SubscriptionScheduler class for subscribing to many symbols by priority.
+ *
+ * This file contains the definition of the SubscriptionScheduler class, which sends the
+ * subscriptions of a large symbol universe over one or more streams, the most important first.
+ */
+
+#include "XStationClientStream.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace xapi
+{
+
+/**
+ * @brief Kind of data a scheduled subscription streams.
+ */
+enum class SubscriptionType
+{
+    TickPrices,
+    Candles
+};
+
+/**
+ * @brief Subscription to the data of one symbol, sent by a SubscriptionScheduler.
+ */
+struct Subscription
+{
+    /**
+     * Symbol to subscribe to.
+     */
+    std::string symbol;
+
+    /**
+     * Kind of data to stream.
+     */
+    SubscriptionType type = SubscriptionType::TickPrices;
+
+    /**
+     * Subscriptions with a higher priority are sent first, equal priorities in the order they were scheduled.
+     */
+    int priority = 0;
+
+    /**
+     * Minimal interval in milliseconds between two tick prices, see XStationClientStream::getTickPrices().
+     */
+    int minArrivalTime = 0;
+
+    /**
+     * Maximal level of the tick prices, see XStationClientStream::getTickPrices().
+     */
+    int maxLevel = 2;
+};
+
+/**
+ * @brief Progress of the subscriptions of a SubscriptionScheduler.
+ */
+struct SubscriptionProgress
+{
+    /**
+     * Number of scheduled subscriptions.
+     */
+    std::size_t total = 0;
+
+    /**
+     * Number of subscriptions sent.
+     */
+    std::size_t live = 0;
+
+    /**
+     * Number of subscriptions that could not be sent on any stream, or failed with another error.
+     */
+    std::size_t failed = 0;
+
+    /**
+     * @brief Gets the number of subscriptions still waiting to be sent.
+     * @return The number of pending subscriptions.
+     */
+    std::size_t pending() const
+    {
+        return total - live - failed;
+    }
+};
+
+/**
+ * @brief Sends the subscriptions of a symbol universe over several streams, by priority.
+ *
+ * Every stream sends its subscriptions one at a time, spaced by the rate limiter of its connection,
+ * so a large universe takes a while to go live. The scheduler keeps the waiting subscriptions in
+ * one priority queue and lets every stream take the next one as soon as it is free. Hot symbols
+ * go live first, and faster streams take over more of the work.
+ *
+ * If the connection of a stream closes, its subscription goes back to the queue and the stream
+ * takes no more work. Once no stream is left, the remaining subscriptions are counted as failed.
+ * A subscription failing with any other error is counted as failed and the stream goes on.
+ *
+ * The streams must be open, and they and the scheduler must outlive the scheduled subscriptions.
+ */
+class SubscriptionScheduler final
+{
+  public:
+    SubscriptionScheduler() = delete;
+
+    SubscriptionScheduler(const SubscriptionScheduler &) = delete;
+    SubscriptionScheduler &operator=(const SubscriptionScheduler &) = delete;
+
+    /**
+     * @brief Constructs a new SubscriptionScheduler object.
+     * @param streams The streams to send the subscriptions on, at least one.
+     * @throw std::invalid_argument if no stream is given.
+     */
+    explicit SubscriptionScheduler(std::vector<std::reference_wrapper<XStationClientStream>> streams);
+
+    ~SubscriptionScheduler() = default;
+
+    /**
+     * @brief Adds subscriptions to the queue and starts sending them.
+     *
+     * May be called again while earlier subscriptions are being sent; subscriptions with a
+     * higher priority overtake the waiting ones.
+     *
+     * @param subscriptions The subscriptions to send.
+     * @return An awaitable void, completed once the subscriptions are queued.
+     */
+    boost::asio::awaitable<void> schedule(std::vector<Subscription> subscriptions);
+
+    /**
+     * @brief Waits until every scheduled subscription is live or has failed.
+     * @return An awaitable SubscriptionProgress with the final counts.
+     */
+    boost::asio::awaitable<SubscriptionProgress> waitLive();
+
+    /**
+     * @brief Gets the progress of the scheduled subscriptions, thread safe.
+     * @return The progress.
+     */
+    SubscriptionProgress getProgress() const;
+
+  private:
+    // A waiting subscription, ordered by priority and then by the order it was scheduled in.
+    struct QueuedSubscription
+    {
+        Subscription subscription;
+        std::uint64_t sequence;
+
+        bool operator<(const QueuedSubscription &other) const
+        {
+            if (subscription.priority != other.subscription.priority)
+            {
+                return subscription.priority < other.subscription.priority;
+            }
+            return sequence > other.sequence;
+        }
+    };
+
+    /**
+     * @brief Sends waiting subscriptions on one stream until the queue is empty or the stream fails.
+     * @param index The index of the stream.
+     * @return An awaitable void.
+     */
+    boost::asio::awaitable<void> runWorker(std::size_t index);
+
+    /**
+     * @brief Starts a worker for every stream that has none and has not failed.
+     *
+     * If every stream has failed, the waiting subscriptions are counted as failed instead.
+     */
+    void startWorkers();
+
+    /**
+     * @brief Sends one subscription on a stream.
+     * @param stream The stream.
+     * @param subscription The subscription.
+     * @return An awaitable void.
+     */
+    static boost::asio::awaitable<void> subscribe(XStationClientStream &stream, const Subscription &subscription);
+
+    /**
+     * @brief Checks if every scheduled subscription is live or has failed.
+     * @return True if nothing is waiting or being sent.
+     */
+    bool isDone() const;
+
+    std::vector<std::reference_wrapper<XStationClientStream>> m_streams;
+
+    // Strand the queue and the workers run on.
+    Strand m_strand;
+
+    std::priority_queue<QueuedSubscription> m_queue;
+
+    // Sequence number of the next scheduled subscription.
+    std::uint64_t m_nextSequence;
+
+    // Flags to indicate which streams have a worker running.
+    std::vector<bool> m_workerRunning;
+
+    // Flags to indicate which streams failed and take no more work.
+    std::vector<bool> m_streamFailed;
+
+    // Number of subscriptions being sent.
+    std::size_t m_inFlight;
+
+    // Canceled whenever a subscription is done, to wake up waitLive().
+    boost::asio::steady_timer m_wakeUp;
+
+    std::atomic<std::size_t> m_total;
+    std::atomic<std::size_t> m_live;
+    std::atomic<std::size_t> m_failed;
+};
+
+} // namespace xapi
@@ -0,0 +1,119 @@
+#include "TlsSessionCache.hpp"
+
+namespace xapi
+{
+
+TlsSessionCache::TlsSessionCache() : m_mutex(), m_sessions()
+{
+}
+
+std::shared_ptr<TlsSessionCache> TlsSessionCache::shared()
+{
+    static const std::shared_ptr<TlsSessionCache> sharedCache = std::make_shared<TlsSessionCache>();
+    return sharedCache;
+}
+
+void TlsSessionCache::attach(SSL_CTX *context)
+{
+    // Connections on different threads may attach to the same shared context
+    static std::mutex attachMutex;
+    std::lock_guard<std::mutex> lock(attachMutex);
+    if (SSL_CTX_sess_get_new_cb(context) == &TlsSessionCache::onNewSession)
+    {
+        return;
+    }
+    // Sessions are kept only here, the internal cache of OpenSSL is keyed by session ID and not by server
+    SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(context, &TlsSessionCache::onNewSession);
+}
+
+bool TlsSessionCache::resume(SSL *ssl, const std::string &host, const std::string &port)
+{
+    SessionKey key{host, port, contextId(SSL_get_SSL_CTX(ssl))};
+
+    // Replaces the attachment of an earlier handshake on the same connection, if any
+    delete static_cast<Attachment *>(SSL_get_ex_data(ssl, sslIndex()));
+    SSL_set_ex_data(ssl, sslIndex(), new Attachment{this, key});
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto session = m_sessions.find(key);
+    if (session == m_sessions.end())
+    {
+        return false;
+    }
+    // The connection gets its own copy. OpenSSL marks the session of a connection that is not
+    // shut down cleanly as not resumable, which must not spoil the cached one.
+    std::unique_ptr<SSL_SESSION, SessionDeleter> sessionCopy(SSL_SESSION_dup(session->second.get()));
+    return sessionCopy && SSL_set_session(ssl, sessionCopy.get()) == 1;
+}
+
+void TlsSessionCache::store(SSL_CTX *context, const std::string &host, const std::string &port,
+                            SSL_SESSION *session)
+{
+    store(SessionKey{host, port, contextId(context)}, session);
+}
+
+void TlsSessionCache::store(SessionKey key, SSL_SESSION *session)
+{
+    std::unique_ptr<SSL_SESSION, SessionDeleter> ownedSession(session);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sessions[std::move(key)] = std::move(ownedSession);
+}
+
+std::size_t TlsSessionCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sessions.size();
+}
+
+void TlsSessionCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sessions.clear();
+}
+
+int TlsSessionCache::onNewSession(SSL *ssl, SSL_SESSION *session)
+{
+    const auto *attachment = static_cast<const Attachment *>(SSL_get_ex_data(ssl, sslIndex()));
+    if (attachment == nullptr || !SSL_SESSION_is_resumable(session))
+    {
+        return 0;
+    }
+
+    // A copy is cached for the same reason as in resume(), the connection keeps the original
+    if (SSL_SESSION *sessionCopy = SSL_SESSION_dup(session))
+    {
+        attachment->cache->store(attachment->key, sessionCopy);
+    }
+    return 0;
+}
+
+void TlsSessionCache::freeAttachment(void *, void *attachment, CRYPTO_EX_DATA *, int, long, void *)
+{
+    delete static_cast<Attachment *>(attachment);
+}
+
+int TlsSessionCache::sslIndex()
+{
+    static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &TlsSessionCache::freeAttachment);
+    return index;
+}
+
+std::uint64_t TlsSessionCache::contextId(SSL_CTX *context)
+{
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+
+    // Connections on different threads may share the context
+    static std::mutex idMutex;
+    static std::uint64_t nextId = 1;
+    std::lock_guard<std::mutex> lock(idMutex);
+    auto id = reinterpret_cast<std::uintptr_t>(SSL_CTX_get_ex_data(context, index));
+    if (id == 0)
+    {
+        id = static_cast<std::uintptr_t>(nextId++);
+        SSL_CTX_set_ex_data(context, index, reinterpret_cast<void *>(id));
+    }
+    return id;
+}
+
+} // namespace xapi
@@ -0,0 +1,167 @@
+#pragma once
+
+/**
+ * @file TlsSessionCache.hpp
+ * @brief Defines the TlsSessionCache class for resuming TLS sessions.
+ *
+ * This file contains the definition of the TlsSessionCache class, which keeps the TLS sessions
+ * issued by servers so that later connections to the same server resume them instead of
+ * performing a full handshake.
+ */
+
+#include <openssl/ssl.h>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace xapi
+{
+
+/**
+ * @class TlsSessionCache
+ * @brief Client side cache of TLS sessions, keyed by server host, port and SSL context.
+ *
+ * Sessions and TLS 1.3 tickets issued on a connection are collected into the cache that resumed
+ * it, and offered to the next handshake with the same host and port through the same SSL context.
+ * A session is never resumed through another context, e.g. one verifying the certificates that
+ * the context the session was established with did not verify. The cache is thread safe and one
+ * instance may be shared by all connections, so the stream connection and reconnects of a
+ * client resume the session of its first connection.
+ */
+class TlsSessionCache final
+{
+  public:
+    TlsSessionCache(const TlsSessionCache &) = delete;
+    TlsSessionCache &operator=(const TlsSessionCache &) = delete;
+
+    TlsSessionCache();
+
+    ~TlsSessionCache() = default;
+
+    /**
+     * @brief Gets the cache shared by connections that are not given their own.
+     * @return The process-wide cache.
+     */
+    static std::shared_ptr<TlsSessionCache> shared();
+
+    /**
+     * @brief Enables collecting sessions on the SSL context.
+     *
+     * The context may be shared by connections with different caches, or with none. Sessions are
+     * collected only on connections passed to resume(), into the cache that was asked.
+     *
+     * @param context The client SSL context.
+     */
+    static void attach(SSL_CTX *context);
+
+    /**
+     * @brief Offers the cached session of the server to a connection before its handshake.
+     *
+     * Sessions the server issues on this connection are collected into this cache. The cache
+     * must outlive the handshake and the connection.
+     *
+     * @param ssl The connection to resume the session on.
+     * @param host The server host name.
+     * @param port The server port.
+     * @return true if a session was offered.
+     */
+    bool resume(SSL *ssl, const std::string &host, const std::string &port);
+
+    /**
+     * @brief Stores a session of the server, replacing the previous one.
+     * @param context The SSL context the session was established with.
+     * @param host The server host name.
+     * @param port The server port.
+     * @param session The session. The cache takes over one reference to it.
+     */
+    void store(SSL_CTX *context, const std::string &host, const std::string &port, SSL_SESSION *session);
+
+    /**
+     * @brief Gets the number of servers with a cached session.
+     * @return The number of cached sessions.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Drops all cached sessions.
+     */
+    void clear();
+
+  private:
+    /**
+     * What a session is cached by.
+     */
+    struct SessionKey
+    {
+        std::string host;
+        std::string port;
+
+        // Id of the SSL context, unlike its address never reused by a later context.
+        std::uint64_t context;
+
+        auto operator<=>(const SessionKey &) const = default;
+    };
+
+    /**
+     * The cache and the key of a connection, kept in its SSL ex_data until the connection is freed.
+     */
+    struct Attachment
+    {
+        TlsSessionCache *cache;
+        SessionKey key;
+    };
+
+    /**
+     * @brief OpenSSL callback for sessions issued by the server.
+     * @param ssl The connection the session was issued on.
+     * @param session The new session.
+     * @return Always 0, the cache keeps a copy and not the reference passed in.
+     */
+    static int onNewSession(SSL *ssl, SSL_SESSION *session);
+
+    /**
+     * @brief OpenSSL callback freeing the Attachment of a connection.
+     */
+    static void freeAttachment(void *parent, void *attachment, CRYPTO_EX_DATA *exData, int index, long argl,
+                               void *argp);
+
+    /**
+     * @brief Gets the index of the SSL ex_data slot holding the Attachment of a connection.
+     * @return The ex_data index.
+     */
+    static int sslIndex();
+
+    /**
+     * @brief Gets the id of an SSL context, assigned on first use.
+     * @param context The SSL context.
+     * @return The id, unique for the lifetime of the process.
+     */
+    static std::uint64_t contextId(SSL_CTX *context);
+
+    /**
+     * @brief Stores a session under its key, replacing the previous one.
+     * @param key The key of the session.
+     * @param session The session. The cache takes over one reference to it.
+     */
+    void store(SessionKey key, SSL_SESSION *session);
+
+    struct SessionDeleter
+    {
+        void operator()(SSL_SESSION *session) const
+        {
+            SSL_SESSION_free(session);
+        }
+    };
+
+    // Protects m_sessions, the cache may be shared between threads.
+    mutable std::mutex m_mutex;
+
+    // The latest session of every server and SSL context.
+    std::map<SessionKey, std::unique_ptr<SSL_SESSION, SessionDeleter>> m_sessions;
+};
+
+} // namespace xapi
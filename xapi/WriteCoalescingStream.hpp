@@ -0,0 +1,225 @@
+#pragma once
+
+/**
+ * @file WriteCoalescingStream.hpp
+ * @brief Defines the WriteCoalescingStream class for gathering several writes into one.
+ *
+ * The stream sits between the WebSocket stream and the TLS (or TCP) stream of a connection.
+ * While it is corked, the frames written by the WebSocket stream are gathered in a buffer and
+ * sent with a single write on flush, i.e. in one TLS record and one system call where possible.
+ */
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket/teardown.hpp>
+#include <string>
+#include <utility>
+
+namespace xapi
+{
+namespace internals
+{
+
+/**
+ * @class WriteCoalescingStream
+ * @brief Stream layer that holds back writes while corked and sends them together on flush.
+ *
+ * When not corked, reads and writes, asynchronous or not, are passed through to the next layer.
+ * While corked, or while a flush is in progress, writes are appended to a buffer and complete at
+ * once, so the layer above
+ * (e.g. a WebSocket stream sending several messages, pings or pongs) keeps its own framing and
+ * ordering. The stream must be used from a single strand.
+ *
+ * @tparam NextLayer The stream the gathered writes are sent to.
+ */
+template <typename NextLayer> class WriteCoalescingStream
+{
+  public:
+    using executor_type = typename NextLayer::executor_type;
+    using next_layer_type = NextLayer;
+
+    /**
+     * @brief Constructs the stream and its next layer.
+     * @param args The arguments of the next layer.
+     */
+    template <typename... Args>
+    explicit WriteCoalescingStream(Args &&...args) : m_nextLayer(std::forward<Args>(args)...)
+    {
+    }
+
+    executor_type get_executor() noexcept
+    {
+        return m_nextLayer.get_executor();
+    }
+
+    NextLayer &next_layer() noexcept
+    {
+        return m_nextLayer;
+    }
+
+    const NextLayer &next_layer() const noexcept
+    {
+        return m_nextLayer;
+    }
+
+    /**
+     * @brief Holds back the following writes until flush().
+     */
+    void cork()
+    {
+        m_corked = true;
+    }
+
+    /**
+     * @brief Sends the writes held back since cork() and stops holding them back.
+     *
+     * Writes made while the flush is in progress are sent after the pending ones.
+     *
+     * @return An awaitable void.
+     * @throw boost::system::system_error if the write fails. The held back data is dropped.
+     */
+    boost::asio::awaitable<void> flush()
+    {
+        boost::system::error_code error;
+        co_await flush(error);
+        if (error)
+        {
+            throw boost::system::system_error(error);
+        }
+    }
+
+    /**
+     * @brief Sends the writes held back since cork() and stops holding them back, without throwing.
+     * @param error Set to the error if the write fails. The held back data is dropped.
+     * @return An awaitable void.
+     */
+    boost::asio::awaitable<void> flush(boost::system::error_code &error)
+    {
+        m_corked = false;
+        m_flushing = true;
+        error = {};
+        while (!m_pending.empty() && !error)
+        {
+            std::swap(m_pending, m_inFlight);
+            co_await boost::asio::async_write(m_nextLayer, boost::asio::buffer(m_inFlight),
+                                              boost::asio::redirect_error(boost::asio::use_awaitable, error));
+            m_inFlight.clear();
+        }
+        m_flushing = false;
+
+        if (error)
+        {
+            m_pending.clear();
+        }
+    }
+
+    template <typename MutableBufferSequence> std::size_t read_some(const MutableBufferSequence &buffers)
+    {
+        return m_nextLayer.read_some(buffers);
+    }
+
+    template <typename MutableBufferSequence>
+    std::size_t read_some(const MutableBufferSequence &buffers, boost::system::error_code &error)
+    {
+        return m_nextLayer.read_some(buffers, error);
+    }
+
+    template <typename ConstBufferSequence> std::size_t write_some(const ConstBufferSequence &buffers)
+    {
+        boost::system::error_code error;
+        const std::size_t size = write_some(buffers, error);
+        if (error)
+        {
+            throw boost::system::system_error(error);
+        }
+        return size;
+    }
+
+    template <typename ConstBufferSequence>
+    std::size_t write_some(const ConstBufferSequence &buffers, boost::system::error_code &error)
+    {
+        if (!m_corked && !m_flushing)
+        {
+            return m_nextLayer.write_some(buffers, error);
+        }
+        error = {};
+        return hold(buffers);
+    }
+
+    template <typename MutableBufferSequence, typename ReadToken>
+    auto async_read_some(const MutableBufferSequence &buffers, ReadToken &&token)
+    {
+        return m_nextLayer.async_read_some(buffers, std::forward<ReadToken>(token));
+    }
+
+    template <typename ConstBufferSequence, typename WriteToken>
+    auto async_write_some(const ConstBufferSequence &buffers, WriteToken &&token)
+    {
+        return boost::asio::async_initiate<WriteToken, void(boost::system::error_code, std::size_t)>(
+            [this](auto handler, const ConstBufferSequence &buffers) {
+                if (!m_corked && !m_flushing)
+                {
+                    m_nextLayer.async_write_some(buffers, std::move(handler));
+                    return;
+                }
+
+                const std::size_t size = hold(buffers);
+                const auto executor = boost::asio::get_associated_executor(handler, m_nextLayer.get_executor());
+                boost::asio::post(executor, boost::beast::bind_front_handler(std::move(handler),
+                                                                             boost::system::error_code(), size));
+            },
+            token, buffers);
+    }
+
+  private:
+    /**
+     * @brief Appends a write to the held back data.
+     * @param buffers The data to write.
+     * @return The number of bytes held back.
+     */
+    template <typename ConstBufferSequence> std::size_t hold(const ConstBufferSequence &buffers)
+    {
+        const std::size_t size = boost::asio::buffer_size(buffers);
+        const std::size_t offset = m_pending.size();
+        m_pending.resize(offset + size);
+        boost::asio::buffer_copy(boost::asio::buffer(m_pending.data() + offset, size), buffers);
+        return size;
+    }
+
+    NextLayer m_nextLayer;
+
+    // Flag to indicate if writes are held back.
+    bool m_corked = false;
+
+    // Flag to indicate if the held back writes are being sent.
+    bool m_flushing = false;
+
+    // Writes held back since cork(), or made during the flush.
+    std::string m_pending;
+
+    // Writes being sent by flush(), swapped with m_pending so both keep their capacity.
+    std::string m_inFlight;
+};
+
+/**
+ * @brief Tears down the next layer when the WebSocket stream is closed.
+ */
+template <typename NextLayer>
+void teardown(boost::beast::role_type role, WriteCoalescingStream<NextLayer> &stream, boost::beast::error_code &error)
+{
+    using boost::beast::websocket::teardown;
+    teardown(role, stream.next_layer(), error);
+}
+
+/**
+ * @brief Tears down the next layer asynchronously when the WebSocket stream is closed.
+ */
+template <typename NextLayer, typename TeardownHandler>
+void async_teardown(boost::beast::role_type role, WriteCoalescingStream<NextLayer> &stream, TeardownHandler &&handler)
+{
+    using boost::beast::websocket::async_teardown;
+    async_teardown(role, stream.next_layer(), std::forward<TeardownHandler>(handler));
+}
+
+} // namespace internals
+} // namespace xapi
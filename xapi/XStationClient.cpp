@@ -1,323 +1,427 @@
 #include "XStationClient.hpp"
+#include "CommandTemplate.hpp"
 #include "Exceptions.hpp"
+#include <algorithm>
+#include <boost/asio/experimental/awaitable_operators.hpp>
+#include <charconv>
+#include <chrono>
 
 namespace xapi
 {
 
+namespace
+{
+
+// Command templates, `?` marks a slot filled in at call time.
+constexpr internals::CommandTemplate<2> loginCommand(R"({"command":"login","arguments":{"userId":?,"password":?}})");
+constexpr internals::CommandTemplate<0> logoutCommand(R"({"command":"logout"})");
+constexpr internals::CommandTemplate<0> getAllSymbolsCommand(R"({"command":"getAllSymbols"})");
+constexpr internals::CommandTemplate<0> getCalendarCommand(R"({"command":"getCalendar"})");
+constexpr internals::CommandTemplate<3> getChartLastRequestCommand(
+    R"({"command":"getChartLastRequest","arguments":{"info":{"period":?,"start":?,"symbol":?}}})");
+constexpr internals::CommandTemplate<5> getChartRangeRequestCommand(
+    R"({"command":"getChartRangeRequest","arguments":{"info":{"end":?,"period":?,"start":?,"symbol":?,"ticks":?}}})");
+constexpr internals::CommandTemplate<2> getCommissionDefCommand(
+    R"({"command":"getCommissionDef","arguments":{"symbol":?,"volume":?}})");
+constexpr internals::CommandTemplate<0> getCurrentUserDataCommand(R"({"command":"getCurrentUserData"})");
+constexpr internals::CommandTemplate<2> getIbsHistoryCommand(
+    R"({"command":"getIbsHistory","arguments":{"start":?,"end":?}})");
+constexpr internals::CommandTemplate<0> getMarginLevelCommand(R"({"command":"getMarginLevel"})");
+constexpr internals::CommandTemplate<2> getMarginTradeCommand(
+    R"({"command":"getMarginTrade","arguments":{"symbol":?,"volume":?}})");
+constexpr internals::CommandTemplate<2> getNewsCommand(R"({"command":"getNews","arguments":{"start":?,"end":?}})");
+constexpr internals::CommandTemplate<5> getProfitCalculationCommand(
+    R"({"command":"getProfitCalculation","arguments":{"symbol":?,"cmd":?,"openPrice":?,"closePrice":?,"volume":?}})");
+constexpr internals::CommandTemplate<0> getServerTimeCommand(R"({"command":"getServerTime"})");
+constexpr internals::CommandTemplate<0> getStepRulesCommand(R"({"command":"getStepRules"})");
+constexpr internals::CommandTemplate<1> getSymbolCommand(R"({"command":"getSymbol","arguments":{"symbol":?}})");
+constexpr internals::CommandTemplate<3> getTickPricesCommand(
+    R"({"command":"getTickPrices","arguments":{"symbols":?,"timestamp":?,"level":?}})");
+constexpr internals::CommandTemplate<1> getTradeRecordsCommand(
+    R"({"command":"getTradeRecords","arguments":{"orders":?}})");
+constexpr internals::CommandTemplate<1> getTradesCommand(R"({"command":"getTrades","arguments":{"openedOnly":?}})");
+constexpr internals::CommandTemplate<2> getTradesHistoryCommand(
+    R"({"command":"getTradesHistory","arguments":{"start":?,"end":?}})");
+constexpr internals::CommandTemplate<1> getTradingHoursCommand(
+    R"({"command":"getTradingHours","arguments":{"symbols":?}})");
+constexpr internals::CommandTemplate<0> getVersionCommand(R"({"command":"getVersion"})");
+constexpr internals::CommandTemplate<0> pingCommand(R"({"command":"ping"})");
+constexpr internals::CommandTemplate<11> tradeTransactionCommand(
+    R"({"command":"tradeTransaction","arguments":{"tradeTransInfo":{"cmd":?,"customComment":?,"expiration":?,)"
+    R"("offset":?,"order":?,"price":?,"sl":?,"symbol":?,"tp":?,"type":?,"volume":?}}})");
+constexpr internals::CommandTemplate<1> tradeTransactionStatusCommand(
+    R"({"command":"tradeTransactionStatus","arguments":{"order":?}})");
+
+// Appends the customTag to a rendered command, as the last member of the top level object
+void appendCustomTag(std::string &command, std::uint64_t customTag)
+{
+    char tag[20];
+    const auto result = std::to_chars(std::begin(tag), std::end(tag), customTag);
+
+    command.pop_back();
+    command.append(R"(,"customTag":")");
+    command.append(tag, result.ptr);
+    command.append(R"("})");
+}
+
+} // namespace
+
 const std::unordered_set<std::string> XStationClient::m_knownAccountTypes = {"demo", "real"};
 
 XStationClient::XStationClient(boost::asio::io_context &ioContext, const std::string &accountId,
-                               const std::string &password, const std::string &accountType)
-    : m_ioContext(ioContext), m_connection(std::make_unique<internals::Connection>(ioContext)), m_accountId(accountId), m_password(password),
-      m_accountType(accountType), m_safeMode(true), m_streamSessionId("")
+                               const std::string &password, const std::string &accountType,
+                               const ConnectionOptions &options)
+    : m_ioContext(ioContext), m_strand(boost::asio::make_strand(ioContext)), m_options(options),
+      m_connection(std::make_unique<internals::Connection>(m_strand, options)), m_accountId(accountId), m_password(password),
+      m_accountType(accountType), m_safeMode(true), m_streamSessionId(""), m_commandBuffer(),
+      m_nextCustomTag(1), m_pendingRequests(), m_readingResponses(false),
+      m_alive(std::make_shared<std::atomic<bool>>(true)), m_stopReading(std::make_shared<boost::asio::cancellation_signal>()),
+      m_requestTimeout(0)
+{
+}
+
+XStationClient::~XStationClient()
 {
+    m_alive->store(false);
+
+    // The reader runs on the strand, so its read is canceled there
+    boost::asio::dispatch(m_strand, [stopReading = m_stopReading]() {
+        stopReading->emit(boost::asio::cancellation_type::terminal);
+    });
 }
 
-XStationClient::XStationClient(boost::asio::io_context &ioContext, const boost::json::object &accountCredentials)
+XStationClient::XStationClient(boost::asio::io_context &ioContext, const boost::json::object &accountCredentials,
+                               const ConnectionOptions &options)
     : XStationClient(ioContext,
                      std::string(accountCredentials.at("accountId").as_string()),
                      std::string(accountCredentials.at("password").as_string()),
-                     std::string(accountCredentials.at("accountType").as_string()))
+                     std::string(accountCredentials.at("accountType").as_string()),
+                     options)
+{
+}
+
+boost::asio::awaitable<void> XStationClient::login()
+{
+    internals::unwrap(co_await tryLogin());
+}
+
+boost::asio::awaitable<Result<void>> XStationClient::tryLogin()
 {
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<Result<void>> {
+        StartupReport report;
+        co_return co_await tryConnectAndLogin(report);
+    });
 }
 
-boost::asio::awaitable<void> XStationClient::login() {
-    validateAccountType(m_accountType);
+boost::asio::awaitable<StartupReport> XStationClient::loginWithStream(XStationClientStream &stream)
+{
+    return internals::runOnStrand(m_strand, [this, &stream]() -> boost::asio::awaitable<StartupReport> {
+        using namespace boost::asio::experimental::awaitable_operators;
 
-    const boost::url socketUrl = boost::urls::format("wss://ws.xtb.com/{}", m_accountType);
-    co_await m_connection->connect(socketUrl);
+        const auto start = std::chrono::steady_clock::now();
+        StartupReport report;
+        co_await (connectAndLogin(report) && openStream(stream, report));
 
-    boost::json::object command = {
-        {"command", "login"},
-        {"arguments", {
-            {"userId", m_accountId},
-            {"password", m_password}
-        }}
-    };
-    auto result = co_await request(command);
+        stream.setStreamSessionId(m_streamSessionId);
+        report.total = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        co_return report;
+    });
+}
 
-    if (!result.contains("status") && !result.contains("streamSessionId")) {
-        throw exception::LoginFailed("Invalid response from the server");
+boost::asio::awaitable<void> XStationClient::connectAndLogin(StartupReport &report)
+{
+    internals::unwrap(co_await tryConnectAndLogin(report));
+}
+
+boost::asio::awaitable<Result<void>> XStationClient::tryConnectAndLogin(StartupReport &report)
+{
+    if (auto valid = validateAccountType(m_accountType); !valid)
+    {
+        co_return valid;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const boost::url socketUrl = m_options.endpoint.url(m_accountType);
+    if (auto connected = co_await m_connection->tryConnect(socketUrl); !connected)
+    {
+        co_return connected;
+    }
+    auto end = std::chrono::steady_clock::now();
+    report.connect = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    start = end;
+    loginCommand.render(m_commandBuffer, m_accountId, m_password);
+    auto result = co_await tryRequest(m_commandBuffer);
+    report.login = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    if (!result)
+    {
+        co_return result.error();
     }
 
-    if (result["status"].as_bool() != true)
+    const auto &response = *result;
+    const auto *status = response.if_contains("status");
+    const auto *streamSessionId = response.if_contains("streamSessionId");
+    if (status == nullptr && streamSessionId == nullptr)
     {
-        throw exception::LoginFailed(boost::json::serialize(result));
+        co_return Error::make(Errc::LoginFailed, "Invalid response from the server");
     }
 
-    m_streamSessionId = result["streamSessionId"].as_string();
+    if (status == nullptr || !status->is_bool() || !status->get_bool() || streamSessionId == nullptr ||
+        !streamSessionId->is_string())
+    {
+        Error error = Error::make(Errc::LoginFailed, boost::json::serialize(response));
+        if (const auto *errorCode = response.if_contains("errorCode"); errorCode != nullptr && errorCode->is_string())
+        {
+            error.serverCode = errorCode->get_string();
+        }
+        co_return error;
+    }
+
+    m_streamSessionId = streamSessionId->get_string();
+    co_return Result<void>();
+}
+
+boost::asio::awaitable<void> XStationClient::openStream(XStationClientStream &stream, StartupReport &report)
+{
+    const auto start = std::chrono::steady_clock::now();
+    co_await stream.open();
+    report.streamOpen = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+}
+
+boost::asio::awaitable<void> XStationClient::logout()
+{
+    internals::unwrap(co_await tryLogout());
+}
+
+boost::asio::awaitable<Result<void>> XStationClient::tryLogout()
+{
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<Result<void>> {
+        logoutCommand.render(m_commandBuffer);
+        if (auto result = co_await tryRequest(m_commandBuffer); !result)
+        {
+            co_return result.error();
+        }
+        co_await m_connection->disconnect();
+        co_return Result<void>();
+    });
 }
 
-boost::asio::awaitable<void> XStationClient::logout() {
-    boost::json::object command = {
-        {"command", "logout"}
-    };
-    co_await request(command);
-    co_await m_connection->disconnect();
+const Strand &XStationClient::getStrand() const
+{
+    return m_strand;
+}
 
+std::shared_ptr<const LatencyHistogram> XStationClient::getRttHistogram() const
+{
+    return m_connection->getRttHistogram();
 }
 
 void XStationClient::setSafeMode(bool safeMode) {
     m_safeMode = safeMode;
 }
 
+void XStationClient::setRequestTimeout(std::chrono::milliseconds timeout)
+{
+    m_requestTimeout = timeout;
+}
+
 XStationClientStream XStationClient::getClientStream() const {
-    XStationClientStream stream(m_ioContext, m_accountType, m_streamSessionId);
+    XStationClientStream stream(m_ioContext, m_accountType, m_streamSessionId, m_options);
     return stream;
 }
 
 
 boost::asio::awaitable<boost::json::object> XStationClient::getAllSymbols()
 {
-    boost::json::object command = {
-        {"command", "getAllSymbols"}
-    };   
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<boost::json::object> {
+        getAllSymbolsCommand.render(m_commandBuffer);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getCalendar()
 {
-    boost::json::object command = {
-        {"command", "getCalendar"}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<boost::json::object> {
+        getCalendarCommand.render(m_commandBuffer);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getChartLastRequest(const std::string &symbol, const std::int64_t start,
                                                                 PeriodCode period)
 {
-    boost::json::object command = {
-        {"command", "getChartLastRequest"},
-        {"arguments", {
-            {"info", {
-                {"period", static_cast<int>(period)},
-                {"start", start},
-                {"symbol", symbol}
-            }}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, &symbol, start, period]() -> boost::asio::awaitable<boost::json::object> {
+        getChartLastRequestCommand.render(m_commandBuffer, static_cast<int>(period), start, symbol);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getChartRangeRequest(const std::string &symbol, std::int64_t start, std::int64_t end,
                                                                  PeriodCode period, int ticks)
 {
-    boost::json::object command = {
-        {"command", "getChartRangeRequest"},
-        {"arguments", {
-            {"info", {
-                {"end", end},
-                {"period", static_cast<int>(period)},
-                {"start", start},
-                {"symbol", symbol},
-                {"ticks", ticks}
-            }}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, &symbol, start, end, period, ticks]() -> boost::asio::awaitable<boost::json::object> {
+        getChartRangeRequestCommand.render(m_commandBuffer, end, static_cast<int>(period), start, symbol, ticks);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getCommissionDef(const std::string &symbol, float volume)
 {
-    boost::json::object command = {
-        {"command", "getCommissionDef"},
-        {"arguments", {
-            {"symbol", symbol},
-            {"volume", volume}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, &symbol, volume]() -> boost::asio::awaitable<boost::json::object> {
+        getCommissionDefCommand.render(m_commandBuffer, symbol, volume);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getCurrentUserData()
 {
-    boost::json::object command = {
-        {"command", "getCurrentUserData"}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<boost::json::object> {
+        getCurrentUserDataCommand.render(m_commandBuffer);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getIbsHistory(std::int64_t start, std::int64_t end)
 {
-    boost::json::object command = {
-        {"command", "getIbsHistory"},
-        {"arguments", {
-            {"start", start},
-            {"end", end}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, start, end]() -> boost::asio::awaitable<boost::json::object> {
+        getIbsHistoryCommand.render(m_commandBuffer, start, end);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getMarginLevel()
 {
-    boost::json::object command = {
-        {"command", "getMarginLevel"}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<boost::json::object> {
+        getMarginLevelCommand.render(m_commandBuffer);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getMarginTrade(const std::string &symbol, float volume)
 {
-    boost::json::object command = {
-        {"command", "getMarginTrade"},
-        {"arguments", {
-            {"symbol", symbol},
-            {"volume", volume}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, &symbol, volume]() -> boost::asio::awaitable<boost::json::object> {
+        getMarginTradeCommand.render(m_commandBuffer, symbol, volume);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getNews(std::int64_t start, std::int64_t end)
 {
-    boost::json::object command = {
-        {"command", "getNews"},
-        {"arguments", {
-            {"start", start},
-            {"end", end}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, start, end]() -> boost::asio::awaitable<boost::json::object> {
+        getNewsCommand.render(m_commandBuffer, start, end);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getProfitCalculation(const std::string &symbol, int cmd, float openPrice,
                                                                  float closePrice, float volume)
 {
-    boost::json::object command = {
-        {"command", "getProfitCalculation"},
-        {"arguments", {
-            {"symbol", symbol},
-            {"cmd", cmd},
-            {"openPrice", openPrice},
-            {"closePrice", closePrice},
-            {"volume", volume}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, &symbol, cmd, openPrice, closePrice, volume]() -> boost::asio::awaitable<boost::json::object> {
+        getProfitCalculationCommand.render(m_commandBuffer, symbol, cmd, openPrice, closePrice, volume);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getServerTime()
 {
-    boost::json::object command = {
-        {"command", "getServerTime"}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<boost::json::object> {
+        getServerTimeCommand.render(m_commandBuffer);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getStepRules()
 {
-    boost::json::object command = {
-        {"command", "getStepRules"}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<boost::json::object> {
+        getStepRulesCommand.render(m_commandBuffer);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getSymbol(const std::string &symbol)
 {
-    boost::json::object command = {
-        {"command", "getSymbol"},
-        {"arguments", {
-            {"symbol", symbol}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, &symbol]() -> boost::asio::awaitable<boost::json::object> {
+        getSymbolCommand.render(m_commandBuffer, symbol);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getTickPrices(const std::vector<std::string> &symbols, std::int64_t timestamp,
                                                           int level)
 {
-    boost::json::object command = {
-        {"command", "getTickPrices"},
-        {"arguments", {
-            {"symbols", boost::json::array(symbols.begin(), symbols.end())},
-            {"timestamp", timestamp},
-            {"level", level}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, &symbols, timestamp, level]() -> boost::asio::awaitable<boost::json::object> {
+        getTickPricesCommand.render(m_commandBuffer, symbols, timestamp, level);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getTradeRecords(const std::vector<int> &orders)
 {
-    boost::json::object command = {
-        {"command", "getTradeRecords"},
-        {"arguments", {
-            {"orders", boost::json::array(orders.begin(), orders.end())}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, &orders]() -> boost::asio::awaitable<boost::json::object> {
+        getTradeRecordsCommand.render(m_commandBuffer, orders);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getTrades(bool openedOnly)
 {
-    boost::json::object command = {
-        {"command", "getTrades"},
-        {"arguments", {
-            {"openedOnly", openedOnly}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, openedOnly]() -> boost::asio::awaitable<boost::json::object> {
+        getTradesCommand.render(m_commandBuffer, openedOnly);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getTradesHistory(std::int64_t start, std::int64_t end)
 {
-    boost::json::object command = {
-        {"command", "getTradesHistory"},
-        {"arguments", {
-            {"start", start},
-            {"end", end}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, start, end]() -> boost::asio::awaitable<boost::json::object> {
+        getTradesHistoryCommand.render(m_commandBuffer, start, end);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getTradingHours(const std::vector<std::string> &symbols)
 {
-    boost::json::object command = {
-        {"command", "getTradingHours"},
-        {"arguments", {
-            {"symbols", boost::json::array(symbols.begin(), symbols.end())}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this, &symbols]() -> boost::asio::awaitable<boost::json::object> {
+        getTradingHoursCommand.render(m_commandBuffer, symbols);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::getVersion()
 {
-    boost::json::object command = {
-        {"command", "getVersion"}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<boost::json::object> {
+        getVersionCommand.render(m_commandBuffer);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::ping()
 {
-    boost::json::object command = {
-        {"command", "ping"}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<boost::json::object> {
+        pingCommand.render(m_commandBuffer);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClient::tradeTransaction(const std::string &symbol, TradeCmd cmd, TradeType type,
@@ -325,64 +429,344 @@ boost::asio::awaitable<boost::json::object> XStationClient::tradeTransaction(con
                                                              std::int64_t expiration, int offset,
                                                              const std::string &customComment)
 {
-    if (m_safeMode) {
-        boost::json::object response = {
-            {"status", false},
-            {"errorCode", "N/A"},
-            {"errorDescr", "Trading is disabled when safe=True"}
-        };
-        co_return response;
+    return internals::runOnStrand(m_strand, [this, &symbol, cmd, type, price, volume, sl, tp, order, expiration, offset, &customComment]() -> boost::asio::awaitable<boost::json::object> {
+        if (m_safeMode) {
+            boost::json::object response = {
+                {"status", false},
+                {"errorCode", "N/A"},
+                {"errorDescr", "Trading is disabled when safe=True"}
+            };
+            co_return response;
+        }
+
+        tradeTransactionCommand.render(m_commandBuffer, static_cast<int>(cmd), customComment, expiration, offset, order,
+                                       price, sl, symbol, tp, static_cast<int>(type), volume);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClient::tradeTransactionStatus(int order)
+{
+    return internals::runOnStrand(m_strand, [this, order]() -> boost::asio::awaitable<boost::json::object> {
+        tradeTransactionStatusCommand.render(m_commandBuffer, order);
+        auto result = co_await request(m_commandBuffer);
+        co_return result;
+    });
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::tryGetMarginLevel()
+{
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        getMarginLevelCommand.render(m_commandBuffer);
+        co_return checkStatus(co_await tryRequest(m_commandBuffer));
+    });
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::tryGetMarginTrade(const std::string &symbol, float volume)
+{
+    return internals::runOnStrand(m_strand, [this, &symbol, volume]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        getMarginTradeCommand.render(m_commandBuffer, symbol, volume);
+        co_return checkStatus(co_await tryRequest(m_commandBuffer));
+    });
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::tryGetServerTime()
+{
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        getServerTimeCommand.render(m_commandBuffer);
+        co_return checkStatus(co_await tryRequest(m_commandBuffer));
+    });
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::tryGetSymbol(const std::string &symbol)
+{
+    return internals::runOnStrand(m_strand, [this, &symbol]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        getSymbolCommand.render(m_commandBuffer, symbol);
+        co_return checkStatus(co_await tryRequest(m_commandBuffer));
+    });
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::tryGetTickPrices(const std::vector<std::string> &symbols,
+                                                                                     std::int64_t timestamp, int level)
+{
+    return internals::runOnStrand(m_strand, [this, &symbols, timestamp, level]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        getTickPricesCommand.render(m_commandBuffer, symbols, timestamp, level);
+        co_return checkStatus(co_await tryRequest(m_commandBuffer));
+    });
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::tryGetTrades(bool openedOnly)
+{
+    return internals::runOnStrand(m_strand, [this, openedOnly]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        getTradesCommand.render(m_commandBuffer, openedOnly);
+        co_return checkStatus(co_await tryRequest(m_commandBuffer));
+    });
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::tryPing()
+{
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        pingCommand.render(m_commandBuffer);
+        co_return checkStatus(co_await tryRequest(m_commandBuffer));
+    });
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::tryTradeTransaction(const std::string &symbol, TradeCmd cmd,
+                                                                                        TradeType type, float price, float volume,
+                                                                                        float sl, float tp, int order,
+                                                                                        std::int64_t expiration, int offset,
+                                                                                        const std::string &customComment)
+{
+    return internals::runOnStrand(m_strand, [this, &symbol, cmd, type, price, volume, sl, tp, order, expiration, offset, &customComment]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        if (m_safeMode) {
+            Error error = Error::make(Errc::RequestRejected, "Trading is disabled when safe=True");
+            error.serverCode = "N/A";
+            co_return error;
+        }
+
+        tradeTransactionCommand.render(m_commandBuffer, static_cast<int>(cmd), customComment, expiration, offset, order,
+                                       price, sl, symbol, tp, static_cast<int>(type), volume);
+        co_return checkStatus(co_await tryRequest(m_commandBuffer));
+    });
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::tryTradeTransactionStatus(int order)
+{
+    return internals::runOnStrand(m_strand, [this, order]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        tradeTransactionStatusCommand.render(m_commandBuffer, order);
+        co_return checkStatus(co_await tryRequest(m_commandBuffer));
+    });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClient::request(std::string &command)
+{
+    co_return internals::unwrap(co_await tryRequest(command));
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::tryRequest(std::string &command)
+{
+    if (m_requestTimeout.count() <= 0)
+    {
+        co_return co_await exchange(command);
     }
 
-    boost::json::object command = {
-        {"command", "tradeTransaction"},
-        {"arguments", {
-            {"tradeTransInfo", {
-                {"cmd", static_cast<int>(cmd)},
-                {"customComment", customComment},
-                {"expiration", expiration},
-                {"offset", offset},
-                {"order", order},
-                {"price", price},
-                {"sl", sl},
-                {"symbol", symbol},
-                {"tp", tp},
-                {"type", static_cast<int>(type)},
-                {"volume", volume}
-            }}
-        }}
-    };
-
-    auto result = co_await request(command);
-    co_return result;
+    // The bounded exchange starts later on the strand, by then the shared command buffer may hold
+    // the command of another request
+    std::string boundedCommand = command;
+    co_return co_await withDeadline(exchange(boundedCommand), m_requestTimeout);
 }
 
-boost::asio::awaitable<boost::json::object> XStationClient::tradeTransactionStatus(int order)
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::exchange(std::string &command)
 {
-    boost::json::object command = {
-        {"command", "tradeTransactionStatus"},
-        {"arguments", {
-            {"order", order}
-        }}
-    };
-    auto result = co_await request(command);
-    co_return result;
+    const std::uint64_t customTag = m_nextCustomTag++;
+    appendCustomTag(command, customTag);
+
+    // Registered before sending, the response may be read by a running reader before this coroutine resumes
+    m_pendingRequests.emplace(customTag, PendingRequest());
+    PendingRequestGuard pendingRequestGuard(*this, customTag);
+    if (auto sent = co_await m_connection->trySendMessage(command); !sent)
+    {
+        co_return sent.error();
+    }
+
+    // A send that did not react to the cancellation, e.g. of a deadline, leaves nothing to wait for
+    if ((co_await boost::asio::this_coro::cancellation_state).cancelled() != boost::asio::cancellation_type::none)
+    {
+        Error error;
+        error.code = boost::asio::error::operation_aborted;
+        co_return error;
+    }
+
+    if (!m_readingResponses)
+    {
+        m_readingResponses = true;
+        boost::asio::co_spawn(m_strand, readResponses(),
+                              boost::asio::bind_cancellation_slot(
+                                  m_stopReading->slot(), [stopReading = m_stopReading](std::exception_ptr) {}));
+    }
+
+    co_return co_await waitResponse(customTag);
 }
 
-boost::asio::awaitable<boost::json::object> XStationClient::request(const boost::json::object &command)
+XStationClient::PendingRequestGuard::PendingRequestGuard(XStationClient &client, std::uint64_t customTag)
+    : m_client(client), m_alive(client.m_alive), m_customTag(customTag)
 {
-    co_await m_connection->makeRequest(command);
-    auto result = co_await m_connection->waitResponse();
-    co_return result;
 }
 
-void XStationClient::validateAccountType(const std::string &accountType)
+XStationClient::PendingRequestGuard::~PendingRequestGuard()
+{
+    if (*m_alive)
+    {
+        m_client.m_pendingRequests.erase(m_customTag);
+    }
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClient::waitResponse(std::uint64_t customTag)
+{
+    return boost::asio::async_initiate<const boost::asio::use_awaitable_t<> &, void(Result<boost::json::object>)>(
+        [this, customTag](auto handler) {
+            auto pendingRequest = m_pendingRequests.find(customTag);
+            if (pendingRequest->second.completed)
+            {
+                PendingRequest completedRequest = std::move(pendingRequest->second);
+                m_pendingRequests.erase(pendingRequest);
+                completedRequest.handler = ResponseHandler(std::move(handler));
+                completeRequest(completedRequest, std::move(*completedRequest.result));
+            }
+            else
+            {
+                auto cancellationSlot = boost::asio::get_associated_cancellation_slot(handler);
+                if (cancellationSlot.is_connected())
+                {
+                    cancellationSlot.assign(
+                        [this, customTag](boost::asio::cancellation_type) { cancelRequest(customTag); });
+                }
+                pendingRequest->second.handler = ResponseHandler(std::move(handler));
+            }
+        },
+        boost::asio::use_awaitable);
+}
+
+void XStationClient::cancelRequest(std::uint64_t customTag)
+{
+    auto pendingRequest = m_pendingRequests.find(customTag);
+    if (pendingRequest == m_pendingRequests.end() || !pendingRequest->second.handler)
+    {
+        // Already completed
+        return;
+    }
+
+    PendingRequest canceledRequest = std::move(pendingRequest->second);
+    m_pendingRequests.erase(pendingRequest);
+    Error error;
+    error.code = boost::asio::error::operation_aborted;
+    completeRequest(canceledRequest, std::move(error));
+}
+
+boost::asio::awaitable<void> XStationClient::readResponses()
+{
+    const auto alive = m_alive;
+    const auto connection = m_connection;
+    while (hasOutstandingRequests())
+    {
+        auto response = co_await connection->tryWaitResponse();
+        if (!*alive)
+        {
+            co_return;
+        }
+        if (!response)
+        {
+            failPendingRequests(response.error());
+            break;
+        }
+        routeResponse(std::move(*response));
+    }
+    m_readingResponses = false;
+}
+
+void XStationClient::routeResponse(boost::json::object response)
+{
+    auto pendingRequest = m_pendingRequests.end();
+    if (const auto *customTag = response.if_contains("customTag"); customTag != nullptr && customTag->is_string())
+    {
+        const std::string_view tag = customTag->get_string();
+        std::uint64_t tagValue = 0;
+        if (std::from_chars(tag.data(), tag.data() + tag.size(), tagValue).ec == std::errc())
+        {
+            pendingRequest = m_pendingRequests.find(tagValue);
+        }
+    }
+    else
+    {
+        pendingRequest = std::find_if(m_pendingRequests.begin(), m_pendingRequests.end(),
+                                      [](const auto &request) { return !request.second.completed; });
+    }
+
+    if (pendingRequest == m_pendingRequests.end() || pendingRequest->second.completed)
+    {
+        // The caller is gone, nobody waits for this response
+        return;
+    }
+
+    if (completeRequest(pendingRequest->second, std::move(response)))
+    {
+        m_pendingRequests.erase(pendingRequest);
+    }
+}
+
+bool XStationClient::completeRequest(PendingRequest &pendingRequest, Result<boost::json::object> result)
+{
+    if (!pendingRequest.handler)
+    {
+        pendingRequest.completed = true;
+        pendingRequest.result.emplace(std::move(result));
+        return false;
+    }
+
+    auto handler = std::move(pendingRequest.handler);
+    const auto executor = boost::asio::get_associated_executor(handler);
+    boost::asio::post(executor, [handler = std::move(handler), result = std::move(result)]() mutable {
+        std::move(handler)(std::move(result));
+    });
+    return true;
+}
+
+void XStationClient::failPendingRequests(const Error &error)
+{
+    for (auto pendingRequest = m_pendingRequests.begin(); pendingRequest != m_pendingRequests.end();)
+    {
+        if (!pendingRequest->second.completed && completeRequest(pendingRequest->second, error))
+        {
+            pendingRequest = m_pendingRequests.erase(pendingRequest);
+        }
+        else
+        {
+            ++pendingRequest;
+        }
+    }
+}
+
+bool XStationClient::hasOutstandingRequests() const
+{
+    return std::any_of(m_pendingRequests.begin(), m_pendingRequests.end(),
+                       [](const auto &request) { return !request.second.completed; });
+}
+
+Result<void> XStationClient::validateAccountType(const std::string &accountType)
 {
     if (m_knownAccountTypes.find(accountType) == m_knownAccountTypes.end())
     {
         std::string reason("Invalid account type: " + accountType);
-        throw exception::LoginFailed(reason);
+        return Error::make(Errc::LoginFailed, reason);
+    }
+    return Result<void>();
+}
+
+Result<boost::json::object> XStationClient::checkStatus(Result<boost::json::object> result)
+{
+    if (!result)
+    {
+        return result;
+    }
+
+    const auto *status = result->if_contains("status");
+    if (status == nullptr || !status->is_bool() || status->get_bool())
+    {
+        return result;
+    }
+
+    Error error;
+    error.code = Errc::RequestRejected;
+    if (const auto *errorCode = result->if_contains("errorCode"); errorCode != nullptr && errorCode->is_string())
+    {
+        error.serverCode = errorCode->get_string();
+    }
+    if (const auto *errorDescr = result->if_contains("errorDescr"); errorDescr != nullptr && errorDescr->is_string())
+    {
+        error.description = errorDescr->get_string();
     }
+    return error;
 }
 
 } // namespace xapi
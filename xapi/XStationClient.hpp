@@ -9,16 +9,28 @@
  */
 
 #include "Connection.hpp"
+#include "Deadline.hpp"
+#include "Error.hpp"
+#include "StartupReport.hpp"
 #include "XStationClientStream.hpp"
 #include "Enums.hpp"
+#include <boost/asio/any_completion_handler.hpp>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <optional>
 #include <unordered_set>
 
 #undef TEST_FRIENDS
 #ifdef ENABLE_TEST
 #include "gtest/gtest_prod.h"
 class XStationClientTest;
+class HedgedClientTest;
+class XStationClientPoolTest;
 #define TEST_FRIENDS \
     friend class XStationClientTest; \
+    friend class HedgedClientTest; \
+    friend class XStationClientPoolTest; \
     FRIEND_TEST(XStationClientTest, login_ok); \
     FRIEND_TEST(XStationClientTest, login_invalid_account_type); \
     FRIEND_TEST(XStationClientTest, login_account_credentials_null); \
@@ -36,6 +48,9 @@ namespace xapi
  * The XStationClient class provides a high-level interface for retrieving trading data
  * from xAPI. It is built on top of the Connection class, which handles the
  * low-level details of establishing and maintaining a connection.
+ *
+ * The client and its connection run on their own strand, so the io_context may be run from
+ * several threads. Coroutines spawned on getStrand() call the client without a strand hop.
  */
 class XStationClient final
 {
@@ -45,7 +60,8 @@ class XStationClient final
     XStationClient(const XStationClient &) = delete;
     XStationClient &operator=(const XStationClient &) = delete;
 
-    XStationClient(XStationClient &&other) = default;
+    // Not movable, the detached response reader refers to this
+    XStationClient(XStationClient &&other) = delete;
     XStationClient &operator=(XStationClient &&other) = delete;
 
     /**
@@ -59,9 +75,11 @@ class XStationClient final
      *      - `"demo"` for a demo account.
      *
      *      - `"real"` for a real money account.
+     * @param options The options applied to the connections of the client and of its streams.
      */
     explicit XStationClient(boost::asio::io_context &ioContext, const std::string &accountId,
-                            const std::string &password, const std::string &accountType = "demo");
+                            const std::string &password, const std::string &accountType = "demo",
+                            const ConnectionOptions &options = ConnectionOptions());
 
     /**
      * @brief Constructs a new XStationClient object.
@@ -78,10 +96,34 @@ class XStationClient final
      *
      *    - `accountType`: The type of account. Possible values are: `"demo"` or `"real"`
      *
+     * @param options The options applied to the connections of the client and of its streams.
+     */
+    explicit XStationClient(boost::asio::io_context &ioContext, const boost::json::object &accountCredentials,
+                            const ConnectionOptions &options = ConnectionOptions());
+
+    /**
+     * @brief Destroys the XStationClient object and stops the response reader.
+     *
+     * May run on any thread. The reader sees the client gone at its next step, and its read is
+     * canceled on the strand. Calls of the client itself must have completed.
+     */
+    ~XStationClient();
+
+    /**
+     * @brief Gets the strand the client runs on.
+     * @return The strand of the client.
+     */
+    const Strand &getStrand() const;
+
+    /**
+     * @brief Gets the histogram of the keep-alive ping round trips of the client connection.
+     *
+     * Round trips are measured every ConnectionOptions::keepAliveInterval while the connection is
+     * open. A pong is only seen while the connection is being read, see internals::Connection.
+     *
+     * @return The histogram, thread safe to read.
      */
-    explicit XStationClient(boost::asio::io_context &ioContext, const boost::json::object &accountCredentials);
-    
-    ~XStationClient() = default;
+    std::shared_ptr<const LatencyHistogram> getRttHistogram() const;
 
     /**
      * @brief Opens connection to the server and logs in.
@@ -91,12 +133,43 @@ class XStationClient final
      */
     boost::asio::awaitable<void> login();
 
+    /**
+     * @brief Logs in and opens the stream at the same time.
+     *
+     * The handshakes of the stream connection run while the client connects and logs in, and the
+     * stream session ID is set on the stream as soon as the login returns, so the stream is ready
+     * for subscriptions when the returned awaitable completes. The stream must be created with
+     * getClientStream() and must not be used until then.
+     *
+     * If either phase fails, the other one is asked to stop and the first error is rethrown. The
+     * stream may be left open and should be closed by the caller.
+     *
+     * @param stream The stream to open.
+     * @return An awaitable StartupReport with the time spent in each phase.
+     * @throw xapi::exception::ConnectionClosed if the connection of the client or of the stream fails.
+     * @throw xapi::exception::LoginFailed if the login fails.
+     */
+    boost::asio::awaitable<StartupReport> loginWithStream(XStationClientStream &stream);
+
     /**
      * @brief Logs out from the server and closes the connection(if not closed by server).
      * @return An awaitable void.
      */
     boost::asio::awaitable<void> logout();
 
+    /**
+     * @brief Opens connection to the server and logs in, without throwing.
+     * @return An awaitable Result, Errc::ConnectionClosed if the connection fails or
+     * Errc::LoginFailed if the login fails.
+     */
+    boost::asio::awaitable<Result<void>> tryLogin();
+
+    /**
+     * @brief Logs out from the server and closes the connection, without throwing.
+     * @return An awaitable Result, Errc::ConnectionClosed if the logout cannot be sent.
+     */
+    boost::asio::awaitable<Result<void>> tryLogout();
+
     /**
      * @brief Sets the safe mode flag. If true, you can not send any trade commands and
      * only read-only commands are allowed.
@@ -104,8 +177,22 @@ class XStationClient final
      */
     void setSafeMode(bool safeMode);
 
+    /**
+     * @brief Sets the default deadline of every request.
+     *
+     * A request not answered in time throws xapi::exception::RequestTimeout and its late response
+     * is dropped. A single call can be bounded with withDeadline() instead.
+     *
+     * @param timeout Time a request may take, zero for no deadline (the default).
+     */
+    void setRequestTimeout(std::chrono::milliseconds timeout);
+
     /**
      * @brief Gets the client stream object.
+     *
+     * The stream is constructed with the options of the client, so a rate limiter
+     * set in the options is shared between the client and the stream.
+     *
      * @return The XStationClientStream object.
      */
     XStationClientStream getClientStream() const;
@@ -165,10 +252,70 @@ class XStationClient final
 
     boost::asio::awaitable<boost::json::object> tradeTransactionStatus(int order);
 
+    // Non-throwing variants of the requests on the hot paths. A failed connection is returned as
+    // Errc::ConnectionClosed, a request past its deadline as Errc::RequestTimeout and a response
+    // with `"status": false` as Errc::RequestRejected with its errorCode and errorDescr.
+
+    boost::asio::awaitable<Result<boost::json::object>> tryGetMarginLevel();
+
+    boost::asio::awaitable<Result<boost::json::object>> tryGetMarginTrade(const std::string &symbol, float volume);
+
+    boost::asio::awaitable<Result<boost::json::object>> tryGetServerTime();
+
+    boost::asio::awaitable<Result<boost::json::object>> tryGetSymbol(const std::string &symbol);
+
+    boost::asio::awaitable<Result<boost::json::object>> tryGetTickPrices(const std::vector<std::string> &symbols,
+                                                                         std::int64_t timestamp, int level);
+
+    boost::asio::awaitable<Result<boost::json::object>> tryGetTrades(bool openedOnly);
+
+    boost::asio::awaitable<Result<boost::json::object>> tryPing();
+
+    boost::asio::awaitable<Result<boost::json::object>> tryTradeTransaction(const std::string &symbol, TradeCmd cmd,
+                                                                            TradeType type, float price, float volume,
+                                                                            float sl, float tp, int order,
+                                                                            std::int64_t expiration, int offset,
+                                                                            const std::string &customComment);
+
+    boost::asio::awaitable<Result<boost::json::object>> tryTradeTransactionStatus(int order);
+
+    /**
+     * @brief Starts an asynchronous method of the client with any asio completion token.
+     *
+     * The token is the last argument: a callback, boost::asio::deferred, boost::asio::use_future,
+     * boost::asio::as_tuple() or an operand of boost::asio::experimental::make_parallel_group(), e.g.
+     *
+     *     auto symbol = client.async<&xapi::XStationClient::getSymbol>(std::string("EURUSD"), boost::asio::use_future);
+     *
+     * The completion signature is `void(std::exception_ptr, boost::json::object)`, with the
+     * exception the awaitable method would throw, `void(std::exception_ptr)` for the methods
+     * returning void and `void(std::exception_ptr, Result<...>)` for the `try` variants. Default
+     * arguments of the method must be passed. The operation runs as a coroutine spawned on the
+     * strand, so awaiting the method directly is cheaper where a coroutine is at hand.
+     *
+     * @tparam Method The method, e.g. `&xapi::XStationClient::getSymbol`.
+     * @param argumentsAndToken The arguments of the method followed by the completion token. The
+     *                          arguments are copied, so they need not outlive the call. An argument
+     *                          passed with std::ref(), e.g. the stream of loginWithStream(), is not
+     *                          copied and must outlive the operation.
+     * @return Whatever the completion token returns, e.g. void for a callback.
+     */
+    template <auto Method, typename... ArgumentsAndToken> auto async(ArgumentsAndToken &&...argumentsAndToken)
+    {
+        return internals::asyncInvoke<Method>(m_strand, *this,
+                                              std::forward<ArgumentsAndToken>(argumentsAndToken)...);
+    }
+
   private:
 
     boost::asio::io_context &m_ioContext;
-    std::unique_ptr<internals::IConnection> m_connection;
+
+    // Strand all handlers of the client and of its connection run on.
+    Strand m_strand;
+
+    const ConnectionOptions m_options;
+    // Shared with the response reader, which may finish after the client is destroyed.
+    std::shared_ptr<internals::IConnection> m_connection;
 
     const std::string m_accountId;
     const std::string m_password;
@@ -181,22 +328,190 @@ class XStationClient final
 
     std::string m_streamSessionId;
 
+    // Buffer the commands are rendered into, reused between calls.
+    std::string m_commandBuffer;
+
+    // Handler completing a request with the response from the server, or with an error.
+    using ResponseHandler = boost::asio::any_completion_handler<void(Result<boost::json::object>)>;
+
+    /**
+     * A request sent to the server, waiting for its response.
+     */
+    struct PendingRequest
+    {
+        // Handler of the caller, empty until the caller starts waiting.
+        ResponseHandler handler;
+
+        // Set when the result arrives before the caller starts waiting.
+        bool completed = false;
+        std::optional<Result<boost::json::object>> result;
+    };
+
+    /**
+     * Forgets a pending request when the exchange ends, also when it is canceled or destroyed while
+     * suspended. A request completed in the meantime is already forgotten.
+     */
+    class PendingRequestGuard final
+    {
+      public:
+        PendingRequestGuard(XStationClient &client, std::uint64_t customTag);
+        ~PendingRequestGuard();
+
+        PendingRequestGuard(const PendingRequestGuard &) = delete;
+        PendingRequestGuard &operator=(const PendingRequestGuard &) = delete;
+
+      private:
+        XStationClient &m_client;
+        const std::shared_ptr<std::atomic<bool>> m_alive;
+        const std::uint64_t m_customTag;
+    };
+
+    // customTag of the next request.
+    std::uint64_t m_nextCustomTag;
+
+    // Requests waiting for a response, by customTag. Ordered, so the oldest request comes first.
+    std::map<std::uint64_t, PendingRequest> m_pendingRequests;
+
+    // Flag to indicate if the coroutine reading responses is running.
+    bool m_readingResponses;
+
+    // Cleared by the destructor, possibly on another thread. The detached response reader holds a
+    // copy and stops once it is false.
+    std::shared_ptr<std::atomic<bool>> m_alive;
+
+    // Emitted on the strand by the destructor to cancel the read of the response reader.
+    std::shared_ptr<boost::asio::cancellation_signal> m_stopReading;
+
+    // Default deadline of the requests, zero for none.
+    std::chrono::milliseconds m_requestTimeout;
+
     // Set of known account types.
     static const std::unordered_set<std::string> m_knownAccountTypes;
 
+    /**
+     * @brief Connects to the server and logs in, recording the time of each phase.
+     * @param report The report to record the connect and login times in.
+     * @return An awaitable void.
+     * @throw xapi::exception::ConnectionClosed if the connection fails.
+     * @throw xapi::exception::LoginFailed if the login fails.
+     */
+    boost::asio::awaitable<void> connectAndLogin(StartupReport &report);
+
+    /**
+     * @brief Connects to the server and logs in like connectAndLogin(), without throwing.
+     * @param report The report to record the connect and login times in.
+     * @return An awaitable Result, Errc::ConnectionClosed or Errc::LoginFailed on failure.
+     */
+    boost::asio::awaitable<Result<void>> tryConnectAndLogin(StartupReport &report);
+
+    /**
+     * @brief Opens the stream, recording the time it takes.
+     * @param stream The stream to open.
+     * @param report The report to record the stream open time in.
+     * @return An awaitable void.
+     */
+    static boost::asio::awaitable<void> openStream(XStationClientStream &stream, StartupReport &report);
+
     /**
      * @brief Sends a request to the server and waits for response.
-     * @param command The command to send as a boost::json::object.
+     *
+     * The command is tagged with a unique customTag, which the server echoes back in the response.
+     * Responses are read by a single coroutine and routed to the waiting requests by tag, so any number
+     * of requests may be in flight at the same time.
+     *
+     * @param command The serialized command to send. The customTag is appended to it.
      * @return An awaitable boost::json::object with the response from the server.
+     * @throw xapi::exception::ConnectionClosed if the request cannot be sent or the connection fails.
+     * @throw xapi::exception::RequestTimeout if a request timeout is set and passes first.
      */
-    boost::asio::awaitable<boost::json::object> request(const boost::json::object &command);
+    boost::asio::awaitable<boost::json::object> request(std::string &command);
+
+    /**
+     * @brief Sends a request to the server and waits for response like request(), without throwing.
+     *
+     * A response with `"status": false` is returned as is, see checkStatus().
+     *
+     * @param command The serialized command to send. The customTag is appended to it.
+     * @return An awaitable Result with the response, Errc::ConnectionClosed or Errc::RequestTimeout on failure.
+     */
+    boost::asio::awaitable<Result<boost::json::object>> tryRequest(std::string &command);
+
+    /**
+     * @brief Sends a tagged request and waits for its response, without a deadline.
+     * @param command The serialized command to send. The customTag is appended to it.
+     * @return An awaitable Result with the response from the server.
+     */
+    boost::asio::awaitable<Result<boost::json::object>> exchange(std::string &command);
+
+    /**
+     * @brief Waits for the response to the request with the given tag.
+     *
+     * The wait can be canceled through the cancellation slot of the caller, e.g. by withDeadline().
+     * A canceled request is forgotten, so its response is dropped when it arrives.
+     *
+     * @param customTag The tag of the request.
+     * @return An awaitable Result with the response from the server, operation_aborted if the wait is canceled.
+     */
+    boost::asio::awaitable<Result<boost::json::object>> waitResponse(std::uint64_t customTag);
+
+    /**
+     * @brief Completes a waiting request with operation_aborted and forgets it.
+     * @param customTag The tag of the request.
+     */
+    void cancelRequest(std::uint64_t customTag);
+
+    /**
+     * @brief Reads responses and routes them to the pending requests, while any request waits for one.
+     *
+     * Detached, it holds the connection and returns without touching the client once it is destroyed.
+     *
+     * @return An awaitable void.
+     */
+    boost::asio::awaitable<void> readResponses();
+
+    /**
+     * @brief Completes the pending request the response belongs to.
+     *
+     * The response is matched by its customTag. A response without customTag belongs to the oldest
+     * request still waiting. Responses to unknown tags are dropped.
+     *
+     * @param response The response from the server.
+     */
+    void routeResponse(boost::json::object response);
+
+    /**
+     * @brief Completes a pending request, or stores the result until the caller starts waiting.
+     * @param pendingRequest The request to complete.
+     * @param result The response or the error to complete the request with.
+     * @return true if the caller was completed and the request can be removed.
+     */
+    static bool completeRequest(PendingRequest &pendingRequest, Result<boost::json::object> result);
+
+    /**
+     * @brief Completes all pending requests with an error.
+     * @param error The error to complete the requests with.
+     */
+    void failPendingRequests(const Error &error);
+
+    /**
+     * @brief Checks if any request still waits for its response.
+     * @return true if a response is outstanding.
+     */
+    bool hasOutstandingRequests() const;
 
     /**
      * @brief Validates the account type.
      * @param accountType The account type to validate.
-     * @throw xapi::exception::ConnectionClosed if the account type is not known.
+     * @return A Result, Errc::LoginFailed if the account type is not known.
+     */
+    static Result<void> validateAccountType(const std::string &accountType);
+
+    /**
+     * @brief Turns a response with `"status": false` into Errc::RequestRejected.
+     * @param result The result of a request.
+     * @return The result, or the rejection with the errorCode and errorDescr of the response.
      */
-    static void validateAccountType(const std::string &accountType);
+    static Result<boost::json::object> checkStatus(Result<boost::json::object> result);
 
     TEST_FRIENDS
 };
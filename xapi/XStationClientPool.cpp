@@ -0,0 +1,232 @@
+#include "XStationClientPool.hpp"
+#include <boost/asio/experimental/parallel_group.hpp>
+#include <stdexcept>
+
+namespace xapi
+{
+
+XStationClientPool::XStationClientPool(boost::asio::io_context &ioContext, const boost::json::object &accountCredentials,
+                                       std::size_t size, const ConnectionOptions &options)
+    : m_strand(boost::asio::make_strand(ioContext)), m_clients(), m_loads(size), m_lastPick(size - 1)
+{
+    if (size == 0)
+    {
+        throw std::invalid_argument("The pool needs at least one session");
+    }
+
+    m_clients.reserve(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        m_clients.push_back(std::make_unique<XStationClient>(ioContext, accountCredentials, options));
+    }
+}
+
+boost::asio::awaitable<void> XStationClientPool::login()
+{
+    return forEachClient([](XStationClient &client) { return client.login(); });
+}
+
+boost::asio::awaitable<void> XStationClientPool::logout()
+{
+    return forEachClient([](XStationClient &client) { return client.logout(); });
+}
+
+std::size_t XStationClientPool::size() const
+{
+    return m_clients.size();
+}
+
+XStationClient &XStationClientPool::getClient(std::size_t index)
+{
+    return *m_clients.at(index);
+}
+
+std::size_t XStationClientPool::getLoad(std::size_t index) const
+{
+    return m_loads.at(index);
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::run(Request request)
+{
+    return internals::runOnStrand(
+        m_strand, [this, request = std::move(request)]() -> boost::asio::awaitable<boost::json::object> {
+            const std::size_t index = leastLoaded();
+            ++m_loads[index];
+
+            boost::json::object response;
+            std::exception_ptr error;
+            try
+            {
+                response = co_await request(*m_clients[index]);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            --m_loads[index];
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+            co_return response;
+        });
+}
+
+std::size_t XStationClientPool::leastLoaded()
+{
+    // Start after the last pick, so that equally loaded sessions take turns
+    std::size_t best = (m_lastPick + 1) % m_clients.size();
+    for (std::size_t offset = 1; offset < m_clients.size(); ++offset)
+    {
+        const std::size_t index = (m_lastPick + 1 + offset) % m_clients.size();
+        if (m_loads[index] < m_loads[best])
+        {
+            best = index;
+        }
+    }
+    m_lastPick = best;
+    return best;
+}
+
+boost::asio::awaitable<void> XStationClientPool::forEachClient(
+    std::function<boost::asio::awaitable<void>(XStationClient &)> operation)
+{
+    using Operation = decltype(boost::asio::co_spawn(m_strand, operation(*m_clients.front()), boost::asio::deferred));
+
+    std::vector<Operation> operations;
+    operations.reserve(m_clients.size());
+    for (auto &client : m_clients)
+    {
+        operations.push_back(boost::asio::co_spawn(m_strand, operation(*client), boost::asio::deferred));
+    }
+
+    auto [order, errors] = co_await boost::asio::experimental::make_parallel_group(std::move(operations))
+                               .async_wait(boost::asio::experimental::wait_for_all(), boost::asio::use_awaitable);
+    for (const std::size_t index : order)
+    {
+        if (errors[index])
+        {
+            std::rethrow_exception(errors[index]);
+        }
+    }
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getAllSymbols()
+{
+    return run([](XStationClient &client) { return client.getAllSymbols(); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getCalendar()
+{
+    return run([](XStationClient &client) { return client.getCalendar(); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getChartLastRequest(const std::string &symbol,
+                                                                                    std::int64_t start,
+                                                                                    PeriodCode period)
+{
+    return run([symbol, start, period](XStationClient &client) {
+        return client.getChartLastRequest(symbol, start, period);
+    });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getChartRangeRequest(const std::string &symbol,
+                                                                                     std::int64_t start,
+                                                                                     std::int64_t end,
+                                                                                     PeriodCode period, int ticks)
+{
+    return run([symbol, start, end, period, ticks](XStationClient &client) {
+        return client.getChartRangeRequest(symbol, start, end, period, ticks);
+    });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getCommissionDef(const std::string &symbol,
+                                                                                 float volume)
+{
+    return run([symbol, volume](XStationClient &client) { return client.getCommissionDef(symbol, volume); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getCurrentUserData()
+{
+    return run([](XStationClient &client) { return client.getCurrentUserData(); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getIbsHistory(std::int64_t start, std::int64_t end)
+{
+    return run([start, end](XStationClient &client) { return client.getIbsHistory(start, end); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getMarginLevel()
+{
+    return run([](XStationClient &client) { return client.getMarginLevel(); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getMarginTrade(const std::string &symbol, float volume)
+{
+    return run([symbol, volume](XStationClient &client) { return client.getMarginTrade(symbol, volume); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getNews(std::int64_t start, std::int64_t end)
+{
+    return run([start, end](XStationClient &client) { return client.getNews(start, end); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getProfitCalculation(const std::string &symbol,
+                                                                                     int cmd, float openPrice,
+                                                                                     float closePrice, float volume)
+{
+    return run([symbol, cmd, openPrice, closePrice, volume](XStationClient &client) {
+        return client.getProfitCalculation(symbol, cmd, openPrice, closePrice, volume);
+    });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getServerTime()
+{
+    return run([](XStationClient &client) { return client.getServerTime(); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getStepRules()
+{
+    return run([](XStationClient &client) { return client.getStepRules(); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getSymbol(const std::string &symbol)
+{
+    return run([symbol](XStationClient &client) { return client.getSymbol(symbol); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getTickPrices(const std::vector<std::string> &symbols,
+                                                                              std::int64_t timestamp, int level)
+{
+    return run([symbols, timestamp, level](XStationClient &client) {
+        return client.getTickPrices(symbols, timestamp, level);
+    });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getTradeRecords(const std::vector<int> &orders)
+{
+    return run([orders](XStationClient &client) { return client.getTradeRecords(orders); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getTrades(bool openedOnly)
+{
+    return run([openedOnly](XStationClient &client) { return client.getTrades(openedOnly); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getTradesHistory(std::int64_t start, std::int64_t end)
+{
+    return run([start, end](XStationClient &client) { return client.getTradesHistory(start, end); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getTradingHours(const std::vector<std::string> &symbols)
+{
+    return run([symbols](XStationClient &client) { return client.getTradingHours(symbols); });
+}
+
+boost::asio::awaitable<boost::json::object> XStationClientPool::getVersion()
+{
+    return run([](XStationClient &client) { return client.getVersion(); });
+}
+
+} // namespace xapi
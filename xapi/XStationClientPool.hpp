@@ -0,0 +1,173 @@
+#pragma once
+
+/**
+ * @file XStationClientPool.hpp
+ * @brief Defines the XStationClientPool class for spreading read-only requests over several sessions.
+ *
+ * This file contains the definition of the XStationClientPool class, which manages several
+ * logged-in sessions of one account and sends every read-only request to the least loaded one.
+ */
+
+#include "XStationClient.hpp"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace xapi
+{
+
+/**
+ * @brief Pool of sessions of one account for parallel read-only requests.
+ *
+ * Every session has its own connection, so requests sent to different sessions do not queue
+ * behind each other. Each request goes to the session with the fewest requests in flight, the
+ * next session in turn among equally loaded ones.
+ *
+ * Unless ConnectionOptions::rateLimiter is set, every session gets its own rate limiter, so the
+ * request rate of the pool grows with its size. A limiter set in the options is shared by all sessions.
+ *
+ * Only read-only requests are offered, trades should be sent through a single XStationClient.
+ */
+class XStationClientPool final
+{
+  public:
+    /**
+     * @brief A read-only request, invoked with the session to send it on.
+     */
+    using Request = std::function<boost::asio::awaitable<boost::json::object>(XStationClient &)>;
+
+    XStationClientPool() = delete;
+
+    XStationClientPool(const XStationClientPool &) = delete;
+    XStationClientPool &operator=(const XStationClientPool &) = delete;
+
+    /**
+     * @brief Constructs a new XStationClientPool object.
+     * @param ioContext The IO context for asynchronous operations.
+     * @param accountCredentials The account credentials, see XStationClient.
+     * @param size Number of sessions, at least one.
+     * @param options The options applied to the connections of every session.
+     * @throw std::invalid_argument if size is zero.
+     */
+    explicit XStationClientPool(boost::asio::io_context &ioContext, const boost::json::object &accountCredentials,
+                                std::size_t size, const ConnectionOptions &options = ConnectionOptions());
+
+    ~XStationClientPool() = default;
+
+    /**
+     * @brief Opens the connections of all sessions and logs them in, in parallel.
+     * @return An awaitable void.
+     * @throw xapi::exception::ConnectionClosed if the connection of a session fails.
+     * @throw xapi::exception::LoginFailed if the login of a session fails.
+     */
+    boost::asio::awaitable<void> login();
+
+    /**
+     * @brief Logs out all sessions, in parallel.
+     * @return An awaitable void.
+     */
+    boost::asio::awaitable<void> logout();
+
+    /**
+     * @brief Gets the number of sessions.
+     * @return The number of sessions.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Gets a session, e.g. to open a stream with its stream session ID.
+     * @param index The index of the session, less than size().
+     * @return The session.
+     */
+    XStationClient &getClient(std::size_t index);
+
+    /**
+     * @brief Gets the number of requests in flight on a session, thread safe.
+     * @param index The index of the session, less than size().
+     * @return The number of requests in flight.
+     */
+    std::size_t getLoad(std::size_t index) const;
+
+    /**
+     * @brief Sends a read-only request on the least loaded session.
+     * @param request The request.
+     * @return An awaitable boost::json::object with the response from the server.
+     */
+    boost::asio::awaitable<boost::json::object> run(Request request);
+
+    // Read-only methods of XStationClient, each sent on the least loaded session.
+
+    boost::asio::awaitable<boost::json::object> getAllSymbols();
+
+    boost::asio::awaitable<boost::json::object> getCalendar();
+
+    boost::asio::awaitable<boost::json::object> getChartLastRequest(const std::string &symbol, std::int64_t start,
+                                                                    PeriodCode period);
+
+    boost::asio::awaitable<boost::json::object> getChartRangeRequest(const std::string &symbol, std::int64_t start,
+                                                                     std::int64_t end, PeriodCode period, int ticks);
+
+    boost::asio::awaitable<boost::json::object> getCommissionDef(const std::string &symbol, float volume);
+
+    boost::asio::awaitable<boost::json::object> getCurrentUserData();
+
+    boost::asio::awaitable<boost::json::object> getIbsHistory(std::int64_t start, std::int64_t end);
+
+    boost::asio::awaitable<boost::json::object> getMarginLevel();
+
+    boost::asio::awaitable<boost::json::object> getMarginTrade(const std::string &symbol, float volume);
+
+    boost::asio::awaitable<boost::json::object> getNews(std::int64_t start, std::int64_t end);
+
+    boost::asio::awaitable<boost::json::object> getProfitCalculation(const std::string &symbol, int cmd,
+                                                                     float openPrice, float closePrice, float volume);
+
+    boost::asio::awaitable<boost::json::object> getServerTime();
+
+    boost::asio::awaitable<boost::json::object> getStepRules();
+
+    boost::asio::awaitable<boost::json::object> getSymbol(const std::string &symbol);
+
+    boost::asio::awaitable<boost::json::object> getTickPrices(const std::vector<std::string> &symbols,
+                                                              std::int64_t timestamp, int level);
+
+    boost::asio::awaitable<boost::json::object> getTradeRecords(const std::vector<int> &orders);
+
+    boost::asio::awaitable<boost::json::object> getTrades(bool openedOnly);
+
+    boost::asio::awaitable<boost::json::object> getTradesHistory(std::int64_t start, std::int64_t end);
+
+    boost::asio::awaitable<boost::json::object> getTradingHours(const std::vector<std::string> &symbols);
+
+    boost::asio::awaitable<boost::json::object> getVersion();
+
+  private:
+    /**
+     * @brief Picks the session with the fewest requests in flight.
+     * @return The index of the session.
+     */
+    std::size_t leastLoaded();
+
+    /**
+     * @brief Runs an operation on every session in parallel.
+     * @param operation The operation, invoked with every session.
+     * @return An awaitable void.
+     * @throw The first exception thrown by an operation, after all operations have completed.
+     */
+    boost::asio::awaitable<void> forEachClient(std::function<boost::asio::awaitable<void>(XStationClient &)> operation);
+
+    // Strand the sessions are picked on.
+    Strand m_strand;
+
+    std::vector<std::unique_ptr<XStationClient>> m_clients;
+
+    // Requests in flight on each session.
+    std::vector<std::atomic<std::size_t>> m_loads;
+
+    // Session after which the search for the least loaded one starts.
+    std::size_t m_lastPick;
+};
+
+} // namespace xapi
@@ -1,179 +1,334 @@
 #include "XStationClientStream.hpp"
+#include "CommandTemplate.hpp"
 #include "Exceptions.hpp"
+#include <boost/asio/experimental/parallel_group.hpp>
+#include <chrono>
 
 namespace xapi
 {
 
-XStationClientStream::XStationClientStream(boost::asio::io_context &ioContext, const std::string &accountType, const std::string& streamSessionId) 
-: m_connection(std::make_unique<internals::Connection>(ioContext)), m_streamUrl(boost::urls::format("wss://ws.xtb.com/{}Stream", accountType)), m_streamSessionId(streamSessionId)
+namespace
 {
+
+// Command templates, `?` marks a slot filled in at call time.
+constexpr internals::CommandTemplate<1> getBalanceCommand(R"({"command":"getBalance","streamSessionId":?})");
+constexpr internals::CommandTemplate<0> stopBalanceCommand(R"({"command":"stopBalance"})");
+constexpr internals::CommandTemplate<2> getCandlesCommand(
+    R"({"command":"getCandles","streamSessionId":?,"symbol":?})");
+constexpr internals::CommandTemplate<1> stopCandlesCommand(R"({"command":"stopCandles","symbol":?})");
+constexpr internals::CommandTemplate<1> getKeepAliveCommand(R"({"command":"getKeepAlive","streamSessionId":?})");
+constexpr internals::CommandTemplate<0> stopKeepAliveCommand(R"({"command":"stopKeepAlive"})");
+constexpr internals::CommandTemplate<1> getNewsCommand(R"({"command":"getNews","streamSessionId":?})");
+constexpr internals::CommandTemplate<0> stopNewsCommand(R"({"command":"stopNews"})");
+constexpr internals::CommandTemplate<1> getProfitsCommand(R"({"command":"getProfits","streamSessionId":?})");
+constexpr internals::CommandTemplate<0> stopProfitsCommand(R"({"command":"stopProfits"})");
+constexpr internals::CommandTemplate<4> getTickPricesCommand(
+    R"({"command":"getTickPrices","streamSessionId":?,"symbol":?,"minArrivalTime":?,"maxLevel":?})");
+constexpr internals::CommandTemplate<1> stopTickPricesCommand(R"({"command":"stopTickPrices","symbol":?})");
+constexpr internals::CommandTemplate<1> getTradesCommand(R"({"command":"getTrades","streamSessionId":?})");
+constexpr internals::CommandTemplate<0> stopTradesCommand(R"({"command":"stopTrades"})");
+constexpr internals::CommandTemplate<1> getTradeStatusCommand(R"({"command":"getTradeStatus","streamSessionId":?})");
+constexpr internals::CommandTemplate<0> stopTradeStatusCommand(R"({"command":"stopTradeStatus"})");
+constexpr internals::CommandTemplate<1> pingCommand(R"({"command":"ping","streamSessionId":?})");
+
+} // namespace
+
+XStationClientStream::XStationClientStream(boost::asio::io_context &ioContext, const std::string &accountType, const std::string& streamSessionId,
+                                           const ConnectionOptions &options)
+: m_strand(boost::asio::make_strand(ioContext)), m_connection(std::make_unique<internals::Connection>(m_strand, options)), m_streamUrl(options.endpoint.url(accountType + "Stream")), m_streamSessionId(streamSessionId),
+  m_streamSessionIdJson(), m_commandBuffer(), m_reconnectPolicy(options.reconnect), m_open(false), m_subscriptions(),
+  m_subscriptionIndex()
+{
+    // The session ID is the same in every command, so it is serialized only once
+    internals::appendJson(m_streamSessionIdJson, m_streamSessionId);
+}
+
+const Strand &XStationClientStream::getStrand() const
+{
+    return m_strand;
+}
+
+std::shared_ptr<const LatencyHistogram> XStationClientStream::getRttHistogram() const
+{
+    return m_connection->getRttHistogram();
+}
+
+void XStationClientStream::setStreamSessionId(const std::string &streamSessionId)
+{
+    m_streamSessionId = streamSessionId;
+    m_streamSessionIdJson.clear();
+    internals::appendJson(m_streamSessionIdJson, m_streamSessionId);
 }
 
 boost::asio::awaitable<void> XStationClientStream::open()
 {
-    co_await m_connection->connect(m_streamUrl);
+    internals::unwrap(co_await tryOpen());
+}
+
+boost::asio::awaitable<Result<void>> XStationClientStream::tryOpen()
+{
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<Result<void>> {
+        auto connected = co_await m_connection->tryConnect(m_streamUrl);
+        if (connected)
+        {
+            m_open = true;
+        }
+        co_return connected;
+    });
 }
 
 boost::asio::awaitable<void> XStationClientStream::close()
 {
-    co_await m_connection->disconnect();
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<void> {
+        m_open = false;
+        co_await m_connection->disconnect();
+    });
 }
 
 boost::asio::awaitable<boost::json::object> XStationClientStream::listen()
 {
-    auto result = co_await m_connection->waitResponse();
-    co_return result;
+    co_return internals::unwrap(co_await tryListen());
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClientStream::tryListen()
+{
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<Result<boost::json::object>> {
+        auto response = co_await m_connection->tryWaitResponse();
+        if (response || !m_reconnectPolicy.enabled || !m_open)
+        {
+            co_return response;
+        }
+        co_return co_await reconnect();
+    });
 }
 
 boost::asio::awaitable<void> XStationClientStream::getBalance()
 {
-    boost::json::object command = {
-        {"command", "getBalance"},
-        {"streamSessionId", m_streamSessionId}
-    };
-    co_await m_connection->makeRequest(command);
+    return subscribe("balance", [](std::string &buffer, const std::string &streamSessionIdJson) {
+        getBalanceCommand.render(buffer, internals::RawJson{streamSessionIdJson});
+    });
 }
 
 boost::asio::awaitable<void> XStationClientStream::stopBalance()
 {
-    boost::json::object command = {
-        {"command", "stopBalance"}
-    };
-    co_await m_connection->makeRequest(command);
+    return unsubscribe("balance", [](std::string &buffer) { stopBalanceCommand.render(buffer); });
 }
 
 boost::asio::awaitable<void> XStationClientStream::getCandles(const std::string &symbol)
 {
-    boost::json::object command = {
-        {"command", "getCandles"},
-        {"streamSessionId", m_streamSessionId},
-        {"symbol", symbol}
-    };
-    co_await m_connection->makeRequest(command);
+    return subscribe("candles:" + symbol, [symbol](std::string &buffer, const std::string &streamSessionIdJson) {
+        getCandlesCommand.render(buffer, internals::RawJson{streamSessionIdJson}, symbol);
+    });
 }
 
 boost::asio::awaitable<void> XStationClientStream::stopCandles(const std::string &symbol)
 {
-    boost::json::object command = {
-        {"command", "stopCandles"},
-        {"symbol", symbol}
-    };
-    co_await m_connection->makeRequest(command);
+    return unsubscribe("candles:" + symbol, [&symbol](std::string &buffer) { stopCandlesCommand.render(buffer, symbol); });
 }
 
 boost::asio::awaitable<void> XStationClientStream::getKeepAlive()
 {
-    boost::json::object command = {
-        {"command", "getKeepAlive"},
-        {"streamSessionId", m_streamSessionId}
-    };
-    co_await m_connection->makeRequest(command);
+    return subscribe("keepAlive", [](std::string &buffer, const std::string &streamSessionIdJson) {
+        getKeepAliveCommand.render(buffer, internals::RawJson{streamSessionIdJson});
+    });
 }
 
 boost::asio::awaitable<void> XStationClientStream::stopKeepAlive()
 {
-    boost::json::object command = {
-        {"command", "stopKeepAlive"}
-    };
-    co_await m_connection->makeRequest(command);
+    return unsubscribe("keepAlive", [](std::string &buffer) { stopKeepAliveCommand.render(buffer); });
 }
 
 boost::asio::awaitable<void> XStationClientStream::getNews()
 {
-    boost::json::object command = {
-        {"command", "getNews"},
-        {"streamSessionId", m_streamSessionId}
-    };
-    co_await m_connection->makeRequest(command);
+    return subscribe("news", [](std::string &buffer, const std::string &streamSessionIdJson) {
+        getNewsCommand.render(buffer, internals::RawJson{streamSessionIdJson});
+    });
 }
 
 boost::asio::awaitable<void> XStationClientStream::stopNews()
 {
-    boost::json::object command = {
-        {"command", "stopNews"}
-    };
-    co_await m_connection->makeRequest(command);
+    return unsubscribe("news", [](std::string &buffer) { stopNewsCommand.render(buffer); });
 }
 
 boost::asio::awaitable<void> XStationClientStream::getProfits()
 {
-    boost::json::object command = {
-        {"command", "getProfits"},
-        {"streamSessionId", m_streamSessionId}
-    };
-    co_await m_connection->makeRequest(command);
+    return subscribe("profits", [](std::string &buffer, const std::string &streamSessionIdJson) {
+        getProfitsCommand.render(buffer, internals::RawJson{streamSessionIdJson});
+    });
 }
 
 boost::asio::awaitable<void> XStationClientStream::stopProfits()
 {
-    boost::json::object command = {
-        {"command", "stopProfits"}
-    };
-    co_await m_connection->makeRequest(command);
+    return unsubscribe("profits", [](std::string &buffer) { stopProfitsCommand.render(buffer); });
 }
 
 boost::asio::awaitable<void> XStationClientStream::getTickPrices(const std::string &symbol, int minArrivalTime, int maxLevel)
 {
-    boost::json::object command = {
-        {"command", "getTickPrices"},
-        {"streamSessionId", m_streamSessionId},
-        {"symbol", symbol},
-        {"minArrivalTime", minArrivalTime},
-        {"maxLevel", maxLevel}
-    };
-    co_await m_connection->makeRequest(command);
+    return subscribe("tickPrices:" + symbol,
+                     [symbol, minArrivalTime, maxLevel](std::string &buffer, const std::string &streamSessionIdJson) {
+                         getTickPricesCommand.render(buffer, internals::RawJson{streamSessionIdJson}, symbol,
+                                                     minArrivalTime, maxLevel);
+                     });
 }
 
 boost::asio::awaitable<void> XStationClientStream::stopTickPrices(const std::string &symbol)
 {
-    boost::json::object command = {
-        {"command", "stopTickPrices"},
-        {"symbol", symbol}
-    };
-    co_await m_connection->makeRequest(command);
+    return unsubscribe("tickPrices:" + symbol, [&symbol](std::string &buffer) { stopTickPricesCommand.render(buffer, symbol); });
 }
 
 boost::asio::awaitable<void> XStationClientStream::getTrades()
 {
-    boost::json::object command = {
-        {"command", "getTrades"},
-        {"streamSessionId", m_streamSessionId}
-    };
-    co_await m_connection->makeRequest(command);
+    return subscribe("trades", [](std::string &buffer, const std::string &streamSessionIdJson) {
+        getTradesCommand.render(buffer, internals::RawJson{streamSessionIdJson});
+    });
 }
 
 boost::asio::awaitable<void> XStationClientStream::stopTrades()
 {
-    boost::json::object command = {
-        {"command", "stopTrades"}
-    };
-    co_await m_connection->makeRequest(command);
+    return unsubscribe("trades", [](std::string &buffer) { stopTradesCommand.render(buffer); });
 }
 
 boost::asio::awaitable<void> XStationClientStream::getTradeStatus()
 {
-    boost::json::object command = {
-        {"command", "getTradeStatus"},
-        {"streamSessionId", m_streamSessionId}
-    };
-    co_await m_connection->makeRequest(command);
+    return subscribe("tradeStatus", [](std::string &buffer, const std::string &streamSessionIdJson) {
+        getTradeStatusCommand.render(buffer, internals::RawJson{streamSessionIdJson});
+    });
 }
 
 boost::asio::awaitable<void> XStationClientStream::stopTradeStatus()
 {
-    boost::json::object command = {
-        {"command", "stopTradeStatus"}
-    };
-    co_await m_connection->makeRequest(command);
+    return unsubscribe("tradeStatus", [](std::string &buffer) { stopTradeStatusCommand.render(buffer); });
 }
 
 boost::asio::awaitable<void> XStationClientStream::ping()
 {
-    boost::json::object command = {
-        {"command", "ping"},
-        {"streamSessionId", m_streamSessionId}
-    };
-    co_await m_connection->makeRequest(command);
+    return internals::runOnStrand(m_strand, [this]() -> boost::asio::awaitable<void> {
+        pingCommand.render(m_commandBuffer, internals::RawJson{m_streamSessionIdJson});
+        co_await m_connection->sendMessage(m_commandBuffer);
+    });
+}
+
+boost::asio::awaitable<void> XStationClientStream::subscribe(std::string key, SubscriptionRenderer render)
+{
+    return internals::runOnStrand(
+        m_strand, [this, key = std::move(key), render = std::move(render)]() -> boost::asio::awaitable<void> {
+            // Recorded before sending, so a subscription sent while the connection drops is replayed
+            // A repeated subscription keeps its place, only its arguments change
+            if (const auto [index, inserted] = m_subscriptionIndex.try_emplace(key, m_subscriptions.size()); inserted)
+            {
+                m_subscriptions.push_back({key, render});
+            }
+            else
+            {
+                m_subscriptions[index->second].render = render;
+            }
+            render(m_commandBuffer, m_streamSessionIdJson);
+            co_await m_connection->sendMessage(m_commandBuffer);
+        });
+}
+
+boost::asio::awaitable<void> XStationClientStream::unsubscribe(std::string key,
+                                                               std::function<void(std::string &)> render)
+{
+    return internals::runOnStrand(
+        m_strand, [this, key = std::move(key), render = std::move(render)]() -> boost::asio::awaitable<void> {
+            if (const auto index = m_subscriptionIndex.find(key); index != m_subscriptionIndex.end())
+            {
+                const std::size_t position = index->second;
+                m_subscriptionIndex.erase(index);
+                m_subscriptions.erase(m_subscriptions.begin() + static_cast<std::ptrdiff_t>(position));
+                for (auto &[otherKey, otherPosition] : m_subscriptionIndex)
+                {
+                    if (otherPosition > position)
+                    {
+                        --otherPosition;
+                    }
+                }
+            }
+            render(m_commandBuffer);
+            co_await m_connection->sendMessage(m_commandBuffer);
+        });
+}
+
+boost::asio::awaitable<Result<boost::json::object>> XStationClientStream::reconnect()
+{
+    const auto lostAt = std::chrono::steady_clock::now();
+    Backoff backoff(m_reconnectPolicy);
+    boost::asio::steady_timer timer(m_strand);
+    int attempts = 0;
+    bool reconnected = false;
+
+    while (!reconnected)
+    {
+        ++attempts;
+        timer.expires_after(backoff.nextDelay());
+        boost::system::error_code ignored;
+        co_await timer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
+        if (!m_open)
+        {
+            co_return Error::make(Errc::ConnectionClosed, "Stream closed while reconnecting");
+        }
+
+        auto result = co_await m_connection->tryConnect(m_streamUrl);
+        if (result)
+        {
+            // Each command still takes its own token from the rate limiter of the connection
+            std::vector<std::string> commands;
+            commands.reserve(m_subscriptions.size());
+            for (const auto &subscription : m_subscriptions)
+            {
+                subscription.render(m_commandBuffer, m_streamSessionIdJson);
+                commands.push_back(m_commandBuffer);
+            }
+            result = co_await sendMessages(commands);
+        }
+
+        reconnected = result.has_value();
+        if (!reconnected && m_reconnectPolicy.maxAttempts > 0 && attempts >= m_reconnectPolicy.maxAttempts)
+        {
+            m_open = false;
+            co_return result.error();
+        }
+    }
+
+    const auto downtime =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lostAt);
+    co_return boost::json::object{
+        {"command", "gap"},
+        {"data",
+         {{"reconnectAttempts", attempts},
+          {"downtime", downtime.count()},
+          {"subscriptions", m_subscriptions.size()}}}};
+}
+
+boost::asio::awaitable<Result<void>> XStationClientStream::sendMessages(const std::vector<std::string> &commands)
+{
+    if (commands.empty())
+    {
+        co_return Result<void>();
+    }
+
+    using Operation = decltype(boost::asio::co_spawn(m_strand, m_connection->trySendMessage(commands.front()),
+                                                     boost::asio::deferred));
+    std::vector<Operation> operations;
+    operations.reserve(commands.size());
+    for (const auto &command : commands)
+    {
+        operations.push_back(
+            boost::asio::co_spawn(m_strand, m_connection->trySendMessage(command), boost::asio::deferred));
+    }
+
+    auto [order, exceptions, results] =
+        co_await boost::asio::experimental::make_parallel_group(std::move(operations))
+            .async_wait(boost::asio::experimental::wait_for_all(), boost::asio::use_awaitable);
+    for (const std::size_t index : order)
+    {
+        if (!results[index])
+        {
+            co_return results[index];
+        }
+    }
+    co_return Result<void>();
 }
 
 } // namespace xapi
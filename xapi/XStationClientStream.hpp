@@ -9,13 +9,20 @@
  */
 
 #include "Connection.hpp"
+#include <functional>
+#include <unordered_map>
+#include <vector>
 
 #undef TEST_FRIENDS
 #ifdef ENABLE_TEST
 #include "gtest/gtest_prod.h"
 class XStationClientStreamTest;
+class XStationClientTest;
+class SubscriptionSchedulerTest;
 #define TEST_FRIENDS \
-    friend class XStationClientStreamTest;
+    friend class XStationClientStreamTest; \
+    friend class XStationClientTest; \
+    friend class SubscriptionSchedulerTest;
 #else
 #define TEST_FRIENDS
 #endif
@@ -27,7 +34,8 @@ namespace xapi
  * @brief Encapsulates operations for streaming real-time data from xAPI.
  *
  * The XStationClientStream class provides a high-level interface for streaming real-time data
- * from xAPI.
+ * from xAPI. The stream and its connection run on their own strand, so the io_context may be
+ * run from several threads.
  */
 class XStationClientStream
 {
@@ -43,10 +51,40 @@ class XStationClientStream
     /**
      * @brief Constructs a new XStationClientStream object.
      * @param ioContext The IO context for asynchronous operations.
+     * @param accountType The type of account, `"demo"` or `"real"`.
+     * @param streamSessionId The stream session ID received on login.
+     * @param options The options applied to the stream connection.
      */
-    explicit XStationClientStream(boost::asio::io_context &ioContext, const std::string &accountType, const std::string& streamSessionId);
+    explicit XStationClientStream(boost::asio::io_context &ioContext, const std::string &accountType, const std::string& streamSessionId,
+                                  const ConnectionOptions &options = ConnectionOptions());
     ~XStationClientStream() = default;
 
+    /**
+     * @brief Gets the strand the stream runs on.
+     * @return The strand of the stream.
+     */
+    const Strand &getStrand() const;
+
+    /**
+     * @brief Gets the histogram of the keep-alive ping round trips of the stream connection.
+     *
+     * Round trips are measured every ConnectionOptions::keepAliveInterval while the connection is
+     * open. A pong is only seen while the connection is being read, see internals::Connection.
+     *
+     * @return The histogram, thread safe to read.
+     */
+    std::shared_ptr<const LatencyHistogram> getRttHistogram() const;
+
+    /**
+     * @brief Sets the stream session ID used by the commands sent from now on.
+     *
+     * Allows the stream to be opened before the login returns the session ID, see
+     * XStationClient::loginWithStream(). Must not be called while a command is being sent.
+     *
+     * @param streamSessionId The stream session ID received on login.
+     */
+    void setStreamSessionId(const std::string &streamSessionId);
+
     /**
      * @brief Opens a connection to the streaming server.
      * @return An awaitable void.
@@ -63,10 +101,37 @@ class XStationClientStream
 
     /**
      * @brief Starts listening for streaming data.
+     *
+     * If reconnects are enabled in the ReconnectPolicy of the options and the connection drops while
+     * the stream is open, the stream reconnects with jittered exponential backoff and sends the active
+     * subscriptions again. It then returns a gap event, since data sent in the meantime is lost:
+     *
+     *     {"command":"gap","data":{"reconnectAttempts":1,"downtime":120,"subscriptions":2}}
+     *
+     * with the downtime in milliseconds and the number of subscriptions sent again.
+     *
      * @return An awaitable boost::json::object with streaming data.
+     * @throw xapi::exception::ConnectionClosed if the connection drops and reconnects are disabled, or
+     * all reconnect attempts fail.
      */
     boost::asio::awaitable<boost::json::object> listen();
 
+    /**
+     * @brief Opens a connection to the streaming server, without throwing.
+     * @return An awaitable Result, Errc::ConnectionClosed if the connection fails.
+     */
+    boost::asio::awaitable<Result<void>> tryOpen();
+
+    /**
+     * @brief Waits for streaming data like listen(), without throwing.
+     *
+     * Reconnects the same way as listen(), and returns the gap event after a reconnect.
+     *
+     * @return An awaitable Result with streaming data, Errc::ConnectionClosed if the connection drops
+     * and reconnects are disabled, or all reconnect attempts fail.
+     */
+    boost::asio::awaitable<Result<boost::json::object>> tryListen();
+
     // Other methods omitted for brevity.
     // Description of the omitted methods: http://developers.xstore.pro/documentation/2.5.0#retrieving-trading-data
 
@@ -104,12 +169,98 @@ class XStationClientStream
 
     boost::asio::awaitable<void> ping();
 
+    /**
+     * @brief Starts an asynchronous method of the stream with any asio completion token.
+     *
+     * Same as XStationClient::async(), e.g.
+     *
+     *     stream.async<&xapi::XStationClientStream::getTickPrices>(std::string("EURUSD"), 0, 2, callback);
+     *
+     * The completion signature is `void(std::exception_ptr)` for the subscriptions,
+     * `void(std::exception_ptr, boost::json::object)` for listen() and
+     * `void(std::exception_ptr, Result<...>)` for the `try` variants.
+     *
+     * @tparam Method The method, e.g. `&xapi::XStationClientStream::getTickPrices`.
+     * @param argumentsAndToken The arguments of the method, copied, followed by the completion token.
+     * @return Whatever the completion token returns, e.g. void for a callback.
+     */
+    template <auto Method, typename... ArgumentsAndToken> auto async(ArgumentsAndToken &&...argumentsAndToken)
+    {
+        return internals::asyncInvoke<Method>(m_strand, *this,
+                                              std::forward<ArgumentsAndToken>(argumentsAndToken)...);
+    }
+
   private:
+    // Strand all handlers of the stream and of its connection run on.
+    Strand m_strand;
+
     std::unique_ptr<internals::IConnection> m_connection;
 
     // The stream session ID.
     const boost::url m_streamUrl;
-    const std::string m_streamSessionId;
+    std::string m_streamSessionId;
+
+    // The stream session ID serialized as JSON string, written into the commands as is.
+    std::string m_streamSessionIdJson;
+
+    // Buffer the commands are rendered into, reused between calls.
+    std::string m_commandBuffer;
+
+    const ReconnectPolicy m_reconnectPolicy;
+
+    // Flag to indicate if the stream was opened and not closed since, i.e. should be reconnected.
+    bool m_open;
+
+    // Renders the command of a subscription with the given serialized stream session ID.
+    using SubscriptionRenderer = std::function<void(std::string &buffer, const std::string &streamSessionIdJson)>;
+
+    /**
+     * An active subscription, keyed by command and symbol.
+     */
+    struct Subscription
+    {
+        std::string key;
+        SubscriptionRenderer render;
+    };
+
+    // Active subscriptions in the order they were made, sent again in that order after a reconnect.
+    std::vector<Subscription> m_subscriptions;
+
+    // Position of each active subscription in m_subscriptions, by key.
+    std::unordered_map<std::string, std::size_t> m_subscriptionIndex;
+
+    /**
+     * @brief Records a subscription and sends its command.
+     * @param key The key of the subscription.
+     * @param render Renders the command of the subscription.
+     * @return An awaitable void.
+     */
+    boost::asio::awaitable<void> subscribe(std::string key, SubscriptionRenderer render);
+
+    /**
+     * @brief Drops a subscription and sends the command stopping it.
+     * @param key The key of the subscription.
+     * @param render Renders the stop command.
+     * @return An awaitable void.
+     */
+    boost::asio::awaitable<void> unsubscribe(std::string key, std::function<void(std::string &)> render);
+
+    /**
+     * @brief Reconnects with backoff and sends the active subscriptions again.
+     * @return An awaitable Result with the gap event, Errc::ConnectionClosed if the stream is closed
+     * meanwhile, or all attempts fail.
+     */
+    boost::asio::awaitable<Result<boost::json::object>> reconnect();
+
+    /**
+     * @brief Queues all commands on the connection at once and waits until they are written.
+     *
+     * Queued together, the commands can be sent in one write if the connection coalesces writes.
+     *
+     * @param commands The serialized commands.
+     * @return An awaitable Result, Errc::ConnectionClosed if a command cannot be sent.
+     */
+    boost::asio::awaitable<Result<void>> sendMessages(const std::vector<std::string> &commands);
 
     TEST_FRIENDS
 };
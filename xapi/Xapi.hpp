@@ -2,7 +2,24 @@
 
 // General xapi header
 
+#include "CompressionOptions.hpp"
+#include "ConnectionOptions.hpp"
+#include "Deadline.hpp"
+#include "Endpoint.hpp"
 #include "Enums.hpp"
+#include "Error.hpp"
 #include "Exceptions.hpp"
+#include "HedgedClient.hpp"
+#include "HedgingOptions.hpp"
+#include "LatencyHistogram.hpp"
+#include "RateLimiter.hpp"
+#include "ReconnectPolicy.hpp"
+#include "ResolverCache.hpp"
+#include "SocketOptions.hpp"
+#include "StartupReport.hpp"
+#include "SubscriptionScheduler.hpp"
+#include "Strand.hpp"
+#include "TlsSessionCache.hpp"
 #include "XStationClient.hpp"
+#include "XStationClientPool.hpp"
 #include "XStationClientStream.hpp"